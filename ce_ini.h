@@ -22,15 +22,37 @@
 #ifndef CE_INI_H
 #define CE_INI_H
 
+#include <stddef.h>
+
+#ifndef CE_INI_NO_STDIO
+#include <stdio.h>
+#endif
+
 #define CE_INI_MAX_SECTION_LENGTH 32
 #define CE_INI_MAX_NAME_LENGTH    32
 #define CE_INI_MAX_VALUE_LENGTH   64
 
+/* Deprecated, kept for source compatibility. CE_INI_Write accepts any
+   number of options and nothing here uses it. */
 #define CE_INI_MAX_WRITE_OPTIONS 256
 
 #define CE_INI_OK    0
 #define CE_INI_ERROR 1
 
+/* Error codes in CE_INI_Error. */
+#define CE_INI_ERROR_NONE      0
+#define CE_INI_ERROR_MEMORY    1 /* out of memory                          */
+#define CE_INI_ERROR_SYNTAX    2 /* missing '=', brackets or quotes        */
+#define CE_INI_ERROR_CHARACTER 3 /* character not allowed at its position  */
+#define CE_INI_ERROR_ESCAPE    4 /* unknown escape sequence                */
+#define CE_INI_ERROR_LENGTH    5 /* section, name or value too long/short  */
+#define CE_INI_ERROR_IO        6 /* file or flush callback failed          */
+#define CE_INI_ERROR_BUFFER    7 /* output buffer too small                */
+#define CE_INI_ERROR_ARGUMENT  8 /* invalid section, name or value to edit */
+#define CE_INI_ERROR_UNKNOWN   9 /* pair not bound in the schema           */
+#define CE_INI_ERROR_VALUE    10 /* value not convertible to its type      */
+#define CE_INI_ERROR_RANGE    11 /* number too large for its type          */
+
 
 /*----------------------------------------------------------------------------
  * API
@@ -40,363 +62,5321 @@ extern "C" {
 #endif
 
 typedef void (*INIReadCallback)(const char *section, const char *name, const char *value, void *userdata);
+typedef void (*INIReadSliceCallback)(const char *section, int section_length, const char *name, int name_length, const char *value, int value_length, void *userdata);
 typedef void (*INIWriteCallback)(int index, char section[CE_INI_MAX_SECTION_LENGTH], char name[CE_INI_MAX_NAME_LENGTH], char value[CE_INI_MAX_VALUE_LENGTH], void *userdata);
+typedef int  (*INIWriteFlushCallback)(const char *data, size_t length, void *userdata);
 
-int CE_INI_Read(const char *text, INIReadCallback callback, void *userdata);
-int CE_INI_Write(char *buffer, int max_length, int option_count, INIWriteCallback callback, void *userdata);
+/* Describes why a function returned CE_INI_ERROR. Errors in the text carry
+   the byte offset and the 1 based line and column (in bytes) of the
+   offending character, other errors have line 0. The message is a static
+   string. */
+typedef struct CE_INI_Error
+{
+    int         code;
+    const char *message;
+    size_t      offset;
+    int         line;
+    int         column;
+} CE_INI_Error;
 
-#ifdef __cplusplus /* extern "C" */
-}
-#endif
+typedef void (*INIErrorCallback)(const CE_INI_Error *error, void *userdata);
 
+/* Nothing is printed, every error is passed to this callback. Like
+   CE_INI_SetStats it is per thread: it gets the errors of the functions
+   called on this thread, other threads set their own. NULL removes it. */
+void CE_INI_SetErrorCallback(INIErrorCallback callback, void *userdata);
 
-#endif /* CE_INI_H */
+int CE_INI_Read(const char *text, INIReadCallback callback, void *userdata);
+int CE_INI_ReadN(const char *text, size_t length, INIReadCallback callback, void *userdata);
 
+/* Like CE_INI_ReadN, also fills in error (code CE_INI_ERROR_NONE on
+   success) if it is not NULL. */
+int CE_INI_ReadEx(const char *text, size_t length, INIReadCallback callback, void *userdata, CE_INI_Error *error);
 
-/*============================================================================
- * IMPLEMENTATION
- *===========================================================================*/
-#ifdef CE_INI_IMPLEMENTATION
+/* Like CE_INI_ReadN but passes slices of the source text to the callback
+   instead of copying into fixed size arrays. Slices are not '\0' terminated
+   and are only valid for the duration of the callback. */
+int CE_INI_ReadSlices(const char *text, size_t length, INIReadSliceCallback callback, void *userdata);
 
-#include <string.h>
-#include <ctype.h>
+/* Bump allocator handing out memory from blocks of at least block_size
+   bytes (CE_INI_ARENA_BLOCK_SIZE when 0). Everything is released at once by
+   CE_INI_ArenaFree. */
+typedef struct CE_INI_ArenaBlock CE_INI_ArenaBlock;
 
-#ifndef CE_INI_ASSERT
-#include <assert.h>
-#define CE_INI_ASSERT(x) assert(x)
-#endif
+typedef struct CE_INI_Arena
+{
+    CE_INI_ArenaBlock *blocks;
+    size_t             block_size;
+} CE_INI_Arena;
 
-#ifndef CE_INI_NO_PRINT
-#include <stdio.h>
-#endif
+void  CE_INI_ArenaInit(CE_INI_Arena *arena, size_t block_size);
+void* CE_INI_ArenaAlloc(CE_INI_Arena *arena, size_t size);
+void  CE_INI_ArenaFree(CE_INI_Arena *arena);
 
+/* Like CE_INI_ReadSlices without any length limits. Quoted values with
+   escape sequences are decoded into the arena, all other slices point into
+   the text. Slices stay valid until the arena is freed (and the text is
+   released). */
+int CE_INI_ReadArena(const char *text, size_t length, CE_INI_Arena *arena, INIReadSliceCallback callback, void *userdata);
 
-/*----------------------------------------------------------------------------
- * Errors
- *---------------------------------------------------------------------------*/
+/* Pull parser. Each CE_INI_Next moves the cursor to the next pair and
+   returns 1, or returns 0 at the end and -1 on an error. The
+   slices are not '\0' terminated and stay valid until the next call. The
+   fields after value are private, reader holds the parser state. */
+typedef struct CE_INI_Cursor
+{
+    const char *section;
+    int         section_length;
+    const char *name;
+    int         name_length;
+    const char *value;
+    int         value_length;
+    const char *text;
+    size_t      length;
+    union
+    {
+        void  *align;
+        double align_double;
+        char   bytes[CE_INI_MAX_VALUE_LENGTH + 128];
+    } reader;
+} CE_INI_Cursor;
 
-static const char* err(const char *msg)
+void CE_INI_CursorInit(CE_INI_Cursor *cursor, const char *text, size_t length);
+int  CE_INI_Next(CE_INI_Cursor *cursor);
+
+/* Errors collected by CE_INI_ReadLenient in source order. */
+typedef struct CE_INI_Diagnostics
 {
-#ifndef CE_INI_NO_PRINT
-    printf("%s\n", msg);
-#endif
-    return NULL;
-}
+    CE_INI_Error *errors;
+    size_t        count;
+    size_t        capacity;
+} CE_INI_Diagnostics;
 
-static int err_i(const char *msg, int result)
+/* Like CE_INI_ReadSlices but does not stop at the first error. Each error
+   is added to diagnostics and parsing continues on the next line, pairs
+   after a broken section header stay in the previous section. Returns
+   CE_INI_ERROR if anything was added (or memory ran out), the error
+   callback is only used for the latter. diagnostics must be zeroed before
+   the first call and released with CE_INI_DiagnosticsFree. */
+int  CE_INI_ReadLenient(const char *text, size_t length, INIReadSliceCallback callback, void *userdata, CE_INI_Diagnostics *diagnostics);
+void CE_INI_DiagnosticsFree(CE_INI_Diagnostics *diagnostics);
+
+/* Incremental parser for text arriving in chunks. Chunks may be split
+   anywhere, pairs are passed to the callback as soon as their line is
+   complete. Memory use is bounded by the longest line, not the input size.
+   CE_INI_Finish parses the last unterminated line and releases the parser. */
+typedef struct CE_INI_Parser
 {
-#ifndef CE_INI_NO_PRINT
-    printf("%s\n", msg);
+    INIReadSliceCallback callback;
+    void   *userdata;
+    char   *line;
+    size_t  line_length;
+    size_t  line_capacity;
+    char   *section;
+    size_t  section_length;
+    size_t  section_capacity;
+    size_t  offset;
+    int     lines;
+    int     error;
+} CE_INI_Parser;
+
+void CE_INI_ParserInit(CE_INI_Parser *parser, INIReadSliceCallback callback, void *userdata);
+int  CE_INI_Feed(CE_INI_Parser *parser, const char *chunk, size_t length);
+int  CE_INI_Finish(CE_INI_Parser *parser);
+
+/* Splits the text at section headers ("\n[") and parses the pieces on up to
+   thread_count threads. Pairs are passed to the callback on the calling
+   thread in source order once all pieces are parsed, so the result is the
+   same as CE_INI_ReadSlices. Requires pthreads, without them (or with
+   CE_INI_NO_THREADS) the text is parsed on the calling thread. */
+int CE_INI_ReadParallel(const char *text, size_t length, int thread_count, INIReadSliceCallback callback, void *userdata);
+
+#ifndef CE_INI_NO_STDIO
+/* Maps the file read only and parses it in place. Falls back to reading the
+   file into memory where mmap is not available. */
+int CE_INI_ReadFile(const char *path, INIReadCallback callback, void *userdata);
 #endif
-    return result;
-}
 
-/*----------------------------------------------------------------------------
- * String Skipping
- *---------------------------------------------------------------------------*/
+/* Parsed document for repeated lookups. Section and name strings are
+   interned into one string arena and pairs are indexed by an open
+   addressing hash table on (section, name). Later duplicates replace earlier
+   values. */
+typedef struct CE_INI_DocEntry
+{
+    size_t   section;
+    size_t   name;
+    size_t   value;
+    unsigned hash;
+} CE_INI_DocEntry;
 
-static const char* skipWhitespace(const char *str)
+typedef struct CE_INI_Doc
 {
-    while(*str && *str != '\n' && (iscntrl(*str) || *str == ' '))
-        str++;
-    return str;
-}
+    char            *strings;
+    size_t           strings_length;
+    size_t           strings_capacity;
+    CE_INI_DocEntry *entries;
+    size_t           entry_count;
+    size_t           table_size;
+} CE_INI_Doc;
+
+int         CE_INI_DocLoad(CE_INI_Doc *doc, const char *text, size_t length);
+const char* CE_INI_Get(const CE_INI_Doc *doc, const char *section, const char *name);
+void        CE_INI_DocFree(CE_INI_Doc *doc);
 
-static const char* skipToFirstReadableChar(const char *str)
+/* Conversions of values, independent of the locale. length is that of the
+   value (as passed to slice callbacks, or strlen), the whole value must
+   match and out is only written on success. Numbers too large for their
+   type, and doubles so small they would round to zero, fail with
+   CE_INI_ERROR_RANGE, anything else with CE_INI_ERROR_VALUE.
+
+   Integers are decimal with an optional sign. Doubles are decimal with an
+   optional fraction and exponent, no hex, inf or nan, and are correctly
+   rounded for any number of digits. Bools are true/false, yes/no, on/off
+   or 1/0 in any case. Sizes are bytes with an optional unit
+   of b, k, m, g, t (powers of 1024, also as kib, mib...) or kb, mb, gb, tb
+   (powers of 1000), like "64MiB" or "64 m". Durations are in nanoseconds,
+   a sequence of numbers with units of ns, us, ms, s, m, h or d like "250ms"
+   or "1h30m". */
+int CE_INI_ToInt(const char *value, int length, int *out);
+int CE_INI_ToLong(const char *value, int length, long long *out);
+int CE_INI_ToDouble(const char *value, int length, double *out);
+int CE_INI_ToBool(const char *value, int length, int *out);
+int CE_INI_ToSize(const char *value, int length, unsigned long long *out);
+int CE_INI_ToDuration(const char *value, int length, long long *out);
+
+/* Types of bound fields, converted like the functions above. Strings are
+   copied '\0' terminated into a char array of the binding's size. */
+#define CE_INI_TYPE_STRING   0 /* char[size]              */
+#define CE_INI_TYPE_INT      1 /* int                     */
+#define CE_INI_TYPE_LONG     2 /* long long               */
+#define CE_INI_TYPE_DOUBLE   3 /* double                  */
+#define CE_INI_TYPE_BOOL     4 /* int, 0 or 1             */
+#define CE_INI_TYPE_SIZE     5 /* unsigned long long      */
+#define CE_INI_TYPE_DURATION 6 /* long long, nanoseconds  */
+
+/* Pairs not in the schema are skipped instead of failing with
+   CE_INI_ERROR_UNKNOWN. */
+#define CE_INI_SCHEMA_IGNORE_UNKNOWN 0x01
+
+/* Stores the value of name in section at offset into the bound struct. */
+typedef struct CE_INI_Binding
 {
-    while(*str && *str && (iscntrl(*str) || *str == ' '))
-        str++;
-    return str;
-}
+    const char *section;
+    const char *name;
+    int         type;
+    size_t      offset;
+    size_t      size;
+} CE_INI_Binding;
+
+#define CE_INI_BIND(section, name, type, struct_type, field) \
+    { section, name, type, offsetof(struct_type, field), sizeof(((struct_type *)0)->field) }
 
-static const char* nextLine(const char *str)
+/* Perfect hash over the bindings, the array is not copied and must stay
+   valid until the schema is freed. Every bucket of the first level hash has
+   a seed that moves its pairs to distinct slots, so a lookup is one hash of
+   the section and name, one slot and one comparison to reject unknown
+   pairs. */
+typedef struct CE_INI_Schema
 {
-    while(*str && *str != '\n')
-        str++;
+    const CE_INI_Binding *bindings;
+    int                   binding_count;
+    int                   flags;
+    unsigned             *hashes;
+    unsigned             *seeds;
+    int                  *slots;
+    unsigned              bucket_mask;
+    unsigned              slot_mask;
+} CE_INI_Schema;
 
-    while(*str && *str == '\n')
-        str++;
+int  CE_INI_SchemaInit(CE_INI_Schema *schema, const CE_INI_Binding *bindings, int binding_count, int flags);
+void CE_INI_SchemaFree(CE_INI_Schema *schema);
 
-    return str;
-}
+/* Parses text and converts every value into the field of object bound to
+   its section and name. Fields of pairs not in the text are left alone. */
+int CE_INI_ReadBound(const char *text, size_t length, const CE_INI_Schema *schema, void *object);
 
-static const char* skipEquality(const char *str)
-{
-    str = skipWhitespace(str);
-    if(*str != '=')
-        return err("equality not found");
-    return skipWhitespace(++str);
-}
+int CE_INI_Write(char *buffer, int max_length, int option_count, INIWriteCallback callback, void *userdata);
 
-/*----------------------------------------------------------------------------
- * Section Parsing
- *---------------------------------------------------------------------------*/
+/* Like CE_INI_Write, also stores the number of bytes written (excluding the
+   terminating '\0') in length if it is not NULL. With a NULL buffer nothing
+   is written and length receives the exact size of the output, a buffer of
+   *length + 1 bytes will hold it. */
+int CE_INI_WriteN(char *buffer, int max_length, int *length, int option_count, INIWriteCallback callback, void *userdata);
+
+/* Writes through a block buffer of CE_INI_WRITE_BLOCK_SIZE bytes which is
+   passed to flush whenever it fills up. flush returns CE_INI_OK or
+   CE_INI_ERROR to abort. The output is not '\0' terminated. */
+int CE_INI_WriteSink(INIWriteFlushCallback flush, void *flush_userdata, int option_count, INIWriteCallback callback, void *userdata);
+
+/* Push style writing, options are added one at a time instead of being
+   queried through a callback. The output is the same as CE_INI_WriteSink
+   with the options in the order they were added. option_count is only a
+   hint for the initial allocation. */
+typedef struct CE_INI_WriteOption CE_INI_WriteOption;
+typedef struct CE_INI_WriteGroup  CE_INI_WriteGroup;
 
-static const char* parseSection(const char *str, char out[CE_INI_MAX_SECTION_LENGTH])
+typedef struct CE_INI_Builder
 {
-    int n = 0;
-    memset(out, '\0', CE_INI_MAX_SECTION_LENGTH);
+    CE_INI_WriteOption *options;
+    int                 option_count;
+    int                 option_capacity;
+    CE_INI_WriteGroup  *groups;
+    int                 group_count;
+    int                 group_capacity;
+    int                *slots;
+    size_t              table_size;
+    char               *strings;
+    size_t              strings_length;
+    size_t              strings_capacity;
+} CE_INI_Builder;
 
-    if(!(*str && *(str++) == '['))
-        return err("start of section not found");
+void CE_INI_BuilderInit(CE_INI_Builder *builder, int option_count);
+int  CE_INI_BuilderAdd(CE_INI_Builder *builder, const char *section, const char *name, const char *value);
+int  CE_INI_BuilderSink(const CE_INI_Builder *builder, INIWriteFlushCallback flush, void *flush_userdata);
+void CE_INI_BuilderFree(CE_INI_Builder *builder);
 
-    while(*str && *str != ']')
-    {
-        if(!(isalnum(*str) || *str == '-' || *str == '_' || *str == ' '))
-            return err("invalid character in section");
+#ifndef CE_INI_NO_STDIO
+/* Sinks writing blocks to a stdio stream or a POSIX file descriptor. */
+int CE_INI_WriteFILE(FILE *file, int option_count, INIWriteCallback callback, void *userdata);
+#if defined(__unix__) || defined(__APPLE__)
+int CE_INI_WriteFd(int fd, int option_count, INIWriteCallback callback, void *userdata);
 
-        if(!(n < CE_INI_MAX_SECTION_LENGTH - 1))
-            return err("section too long");
+/* Replaces path atomically: the output is written to a temporary file in
+   the same directory, synced and renamed over path, then the directory is
+   synced. After a crash path holds either the old or the new contents.
+   An existing file keeps its permission bits. */
+int CE_INI_WriteFile(const char *path, int option_count, INIWriteCallback callback, void *userdata);
+#endif
+#endif
 
-        out[n++] = *(str++);
-    }
+/* Lossless editor. Loading records the byte spans of every pair, saving
+   copies the original text and only splices in the edits: changed values,
+   removed pairs (with their line when they are alone on it) and added
+   pairs, appended to the last line of their section or in a new section at
+   the end. Comments, blank lines, ordering and spacing are kept. The text
+   is not copied and must stay valid until the editor is freed. */
+typedef struct CE_INI_EditorEntry   CE_INI_EditorEntry;
+typedef struct CE_INI_EditorSection CE_INI_EditorSection;
 
-    if(!(*str && *(str++) == ']'))
-        return err("end of section not found");
+typedef struct CE_INI_Editor
+{
+    const char           *text;
+    size_t                length;
+    CE_INI_EditorEntry   *entries;
+    size_t                entry_count;
+    size_t                entry_capacity;
+    CE_INI_EditorSection *sections;
+    size_t                section_count;
+    size_t                section_capacity;
+    int                   new_section_count;
+    size_t               *entry_slots;
+    size_t                entry_table_size;
+    size_t               *section_slots;
+    size_t                section_table_size;
+    CE_INI_Arena          arena;
+} CE_INI_Editor;
 
-    return str;
-}
+int  CE_INI_EditorLoad(CE_INI_Editor *editor, const char *text, size_t length);
+int  CE_INI_EditorSet(CE_INI_Editor *editor, const char *section, const char *name, const char *value);
+int  CE_INI_EditorRemove(CE_INI_Editor *editor, const char *section, const char *name);
+int  CE_INI_EditorSave(const CE_INI_Editor *editor, INIWriteFlushCallback flush, void *userdata);
+void CE_INI_EditorFree(CE_INI_Editor *editor);
 
-/*----------------------------------------------------------------------------
- * Name Parsing
- *---------------------------------------------------------------------------*/
+#if !defined(CE_INI_NO_STDIO) && (defined(__unix__) || defined(__APPLE__)) && (defined(__GNUC__) || defined(__clang__))
+/* Document of a file that is reloaded when the file changes. Readers never
+   lock or wait: each thread takes a reader slot once with
+   CE_INI_StoreRegister (at most reader_count, 0 for 64) and brackets every
+   use of the document between CE_INI_StoreAcquire and CE_INI_StoreRelease.
+   A reload parses into a new document and swaps it in atomically. The old
+   one is freed after a grace period, once no reader that could still be
+   using it is between acquire and release. If the new text fails to parse
+   the current document stays.
 
-static const char* parseName(const char *str, char out[CE_INI_MAX_NAME_LENGTH])
+   CE_INI_StorePoll waits up to timeout_ms for the file to be written or
+   replaced and reloads it. On Linux it waits on inotify, watch_fd can be
+   added to an epoll set to wake up only when needed. Elsewhere the file is
+   checked with stat. Reloads and polls must come from one thread at a
+   time, the store must not have active readers when closed. */
+typedef struct CE_INI_StoreSnapshot CE_INI_StoreSnapshot;
+typedef struct CE_INI_StoreReader   CE_INI_StoreReader;
+
+typedef struct CE_INI_Store
 {
-    int n = 0;
-    memset(out, '\0', CE_INI_MAX_NAME_LENGTH);
+    char                 *path;
+    const char           *name;
+    CE_INI_StoreSnapshot *current;
+    CE_INI_StoreSnapshot *retired;
+    unsigned long long    epoch;
+    CE_INI_StoreReader   *readers;
+    void                 *reader_block;
+    int                   reader_count;
+    int                   watch_fd;
+    long long             mtime;
+    long long             size;
+    unsigned long long    inode;
+} CE_INI_Store;
 
-    while(*str && *str != ' ' && *str != '=')
-    {
-        if(!(isalnum(*str) || *str == '.' || *str == '-' || *str == '_'))
-            return err("invalid character in name");
+int               CE_INI_StoreOpen(CE_INI_Store *store, const char *path, int reader_count);
+int               CE_INI_StoreReload(CE_INI_Store *store);
+int               CE_INI_StorePoll(CE_INI_Store *store, int timeout_ms);
+void              CE_INI_StoreClose(CE_INI_Store *store);
+int               CE_INI_StoreRegister(CE_INI_Store *store);
+void              CE_INI_StoreUnregister(CE_INI_Store *store, int reader);
+const CE_INI_Doc* CE_INI_StoreAcquire(CE_INI_Store *store, int reader);
+void              CE_INI_StoreRelease(CE_INI_Store *store, int reader);
+#endif
 
-        if(!(n < CE_INI_MAX_NAME_LENGTH - 1))
-            return err("name too long");
-            
-        out[n++] = *(str++);
-    }
+#ifdef CE_INI_STATS
+/* Counters added to by the read, edit and write functions called on this
+   thread after CE_INI_SetStats (NULL stops collecting). Times are in
+   nanoseconds, parse_ns and write_ns exclude the time spent in callbacks.
+   CE_INI_DocLoad indexes pairs in a callback, which counts as callback
+   time. Only compiled in when CE_INI_STATS is defined. */
+typedef struct CE_INI_Stats
+{
+    size_t             bytes_scanned;
+    size_t             lines;
+    size_t             sections;
+    size_t             keys;
+    size_t             comments;
+    size_t             escapes;
+    size_t             bytes_written;
+    unsigned long long parse_ns;
+    unsigned long long write_ns;
+    unsigned long long callback_ns;
+} CE_INI_Stats;
 
-    if(n == 0)
-        return err("name too short");
+void CE_INI_SetStats(CE_INI_Stats *stats);
+#endif
 
-    return str;
+#ifdef __cplusplus /* extern "C" */
 }
+#endif
 
 /*----------------------------------------------------------------------------
- * Value Parsing
+ * C++
+ *
+ * Templates on top of the cursor and builder so handlers and sources are
+ * called directly and can be inlined, instead of through a function pointer
+ * per pair or option. Only the sink is called through a pointer, once per
+ * block.
+ *
+ *    ce::ini::read(text, length, [&](const char *section, int section_length,
+ *                                    const char *name, int name_length,
+ *                                    const char *value, int value_length) { ... });
+ *
+ *    ce::ini::write([&](const char *data, size_t length) { ...; return CE_INI_OK; },
+ *                   count, [&](int index, char *section, char *name, char *value) { ... });
+ *
+ * With C++20 a literal can also be parsed at compile time into a read only
+ * table with a hash index, invalid text then fails the build.
+ *
+ *    static constexpr auto defaults = ce::ini::parse<"[server]\nport = 80\n">();
+ *
+ *    defaults.get("server", "port");
+ *    defaults.read(handler);
  *---------------------------------------------------------------------------*/
+#ifdef __cplusplus
+
+#include <string.h>
+#include <type_traits>
+
+namespace ce {
+namespace ini {
 
-static const char* parseUnquotedValue(const char *str, char out[CE_INI_MAX_VALUE_LENGTH])
+template <typename Handler>
+inline int read(const char *text, size_t length, Handler &&handler)
 {
-    int n = 0;
-    memset(out, '\0', CE_INI_MAX_VALUE_LENGTH);
+    CE_INI_Cursor cursor;
+    int result;
 
-    while(*str && (*str != '\n' && *str != '\r') && *str != ';')
+    CE_INI_CursorInit(&cursor, text, length);
+
+    while((result = CE_INI_Next(&cursor)) > 0)
     {
-        if(!(isprint(*str) || *str == '\t'))
-            return err("invalid character in value");
+        handler(cursor.section, cursor.section_length,
+                cursor.name,    cursor.name_length,
+                cursor.value,   cursor.value_length);
+    }
 
-        if(!(n < CE_INI_MAX_VALUE_LENGTH - 1))
-            return err("value too long or too many trailing spaces");
+    return (result < 0) ? CE_INI_ERROR : CE_INI_OK;
+}
 
-        out[n++] = *(str++);
-    }
+template <typename Handler>
+inline int read(const char *text, Handler &&handler)
+{
+    return read(text, strlen(text), static_cast<Handler &&>(handler));
+}
 
-    while(n > 0 && out[n - 1] == ' ')
-        out[--n] = '\0';
+namespace detail {
 
-    return str;
+template <typename Sink>
+int flush(const char *data, size_t length, void *userdata)
+{
+    return (*static_cast<Sink *>(userdata))(data, length);
 }
 
-static const char* parseQuotedValue(const char *str, char out[CE_INI_MAX_VALUE_LENGTH])
+} // namespace detail
+
+template <typename Sink, typename Source>
+inline int write(Sink &&sink, int option_count, Source &&source)
 {
-    int n = 0;
-    memset(out, '\0', CE_INI_MAX_VALUE_LENGTH);
+    typedef typename std::remove_reference<Sink>::type SinkType;
+
+    char section[CE_INI_MAX_SECTION_LENGTH];
+    char name[CE_INI_MAX_NAME_LENGTH];
+    char value[CE_INI_MAX_VALUE_LENGTH];
+    CE_INI_Builder builder;
+    int result = CE_INI_OK;
 
-    if(*str && *(str++) != '"')
-        return err("starting quote not found");
+    CE_INI_BuilderInit(&builder, option_count);
 
-    while(*str && (*str != '\n' && *str != '\r') && *str != ';' && *str != '"')
+    for(int i = 0; i < option_count && result == CE_INI_OK; i++)
     {
-        char c = '\0';
+        source(i, section, name, value);
+        result = CE_INI_BuilderAdd(&builder, section, name, value);
+    }
 
-        if(*str == '\\')
-        {
-            str++;
+    if(result == CE_INI_OK)
+        result = CE_INI_BuilderSink(&builder, &detail::flush<SinkType>, &sink);
 
-            switch(*(str++))
-            {
-                case '"':  c = '"'; c = '"';  break;
-                case '\\': c = '"'; c = '\\'; break;
-                case 't':  c = '"'; c = '\t'; break;
-                case 'n':  c = '"'; c = '\n'; break;
-                default: return err("invalid escape sequence"); break;
-            };
-        }
-        else
-        {
-            if(!(isprint(*str) || *str == '\t'))
-                return err("invalid character in value");
-            c = *(str++);
-        }
+    CE_INI_BuilderFree(&builder);
+
+    return result;
+}
 
-        if(!(n < CE_INI_MAX_VALUE_LENGTH - 1))
-            return err("value too long or too many trailing spaces");
+#if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
 
-        out[n++] = c;
+/* A pair of a compile time table. The strings are '\0' terminated. */
+struct Pair
+{
+    const char *section;
+    int         section_length;
+    const char *name;
+    int         name_length;
+    const char *value;
+    int         value_length;
+};
+
+namespace detail {
+
+/* Text of a string literal as a template argument. */
+template <size_t N>
+struct Literal
+{
+    char text[N];
+
+    constexpr Literal(const char (&str)[N])
+    {
+        for(size_t i = 0; i < N; i++)
+            text[i] = str[i];
     }
+};
 
-    if(*str && *(str++) != '"')
-        return err("ending quote not found");
+/* The character classes of the parser, see char_classes. */
+constexpr bool isWhitespace(char c)  { return (unsigned char)c <= 0x20 || c == 0x7F; }
+constexpr bool isAlnum(char c)       { return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'); }
+constexpr bool isValueChar(char c)   { return c == '\t' || (c >= 0x20 && c < 0x7F && c != ';'); }
+constexpr bool isQuotedChar(char c)  { return isValueChar(c) && c != '"' && c != '\\'; }
+constexpr bool isNameChar(char c)    { return isAlnum(c) || c == '.' || c == '-' || c == '_'; }
+constexpr bool isSectionChar(char c) { return isAlnum(c) || c == '-' || c == '_' || c == ' '; }
 
-    return str;
+/* Same hash as the documents. */
+constexpr unsigned hashBytes(unsigned hash, const char *str, size_t length)
+{
+    for(size_t i = 0; i < length; i++)
+        hash = (hash ^ (unsigned char)str[i]) * 16777619u;
+    return hash;
 }
 
-static const char* parseValue(const char *str, char out[CE_INI_MAX_VALUE_LENGTH])
+constexpr unsigned hashPair(const char *section, size_t section_length, const char *name, size_t name_length)
 {
-    return (*str == '\"') ? parseQuotedValue(str, out) : parseUnquotedValue(str, out);
+    unsigned hash = hashBytes(2166136261u, section, section_length);
+    hash = (hash ^ 0xFFu) * 16777619u;
+    return hashBytes(hash, name, name_length);
 }
 
-/*----------------------------------------------------------------------------
- * INI Parsing
- *---------------------------------------------------------------------------*/
+constexpr size_t length(const char *str)
+{
+    size_t n = 0;
+    while(str[n] != '\0')
+        n++;
+    return n;
+}
 
-int CE_INI_Read(const char *text, INIReadCallback callback, void *userdata)
+constexpr bool equals(const char *a, const char *b, size_t length)
 {
-    CE_INI_ASSERT(callback != NULL);
+    for(size_t i = 0; i < length; i++)
+        if(a[i] != b[i])
+            return false;
+    return true;
+}
 
-    char section[CE_INI_MAX_SECTION_LENGTH];
-    char name[CE_INI_MAX_NAME_LENGTH];
-    char value[CE_INI_MAX_VALUE_LENGTH];
+struct Error
+{
+    int         code;
+    const char *at;
+};
+
+/* readPair with the limits of CE_INI_Read, passing every pair to out.add().
+   Only quoted values with escape sequences are decoded into a buffer. */
+template <typename Out>
+constexpr Error parse(const char *text, size_t length, Out &out)
+{
     const char *str = text;
+    const char *end = text + length;
+    const char *section = text;
+    int section_length = 0;
+    char unescaped[CE_INI_MAX_VALUE_LENGTH] = {};
 
-    while(str != NULL && *str)
+    while(str < end)
     {
-        if(!(str = skipToFirstReadableChar(str)))
-            return CE_INI_ERROR;
+        while(str < end && isWhitespace(*str))
+            str++;
+
+        if(str == end)
+            break;
 
         if(*str == '[')
         {
-            if(!(str = parseSection(str, section)))
-                return CE_INI_ERROR;
+            const char *start = ++str;
+
+            while(str < end && isSectionChar(*str))
+                str++;
+
+            if(str < end && *str != ']')
+                return Error{CE_INI_ERROR_CHARACTER, str};
+
+            if(!(str < end))
+                return Error{CE_INI_ERROR_SYNTAX, str};
+
+            section = start;
+            section_length = (int)(str++ - start);
+
+            if(!(section_length < CE_INI_MAX_SECTION_LENGTH))
+                return Error{CE_INI_ERROR_LENGTH, section};
         }
         else if(*str == ';')
         {
-            if(!(str = nextLine(str)))
-                return CE_INI_ERROR;
+            while(str < end && *str != '\n')
+                str++;
         }
-        else if(*str)
+        else
         {
-            if(!(str = parseName(str, name)))
-                return CE_INI_ERROR;
+            const char *name = str;
+            const char *value;
+            int name_length, value_length;
 
-            if(!(str = skipEquality(str)))
-                return CE_INI_ERROR;
+            while(str < end && isNameChar(*str))
+                str++;
 
-            if(!(str = parseValue(str, value)))
-                return CE_INI_ERROR;
+            if(str < end && *str != ' ' && *str != '=')
+                return Error{CE_INI_ERROR_CHARACTER, str};
+
+            if(str == name)
+                return Error{CE_INI_ERROR_LENGTH, str};
+
+            name_length = (int)(str - name);
+
+            while(str < end && *str != '\n' && isWhitespace(*str))
+                str++;
+
+            if(!(str < end && *str == '='))
+                return Error{CE_INI_ERROR_SYNTAX, str};
 
-            (*callback)(section, name, value, userdata);
+            str++;
+
+            while(str < end && *str != '\n' && isWhitespace(*str))
+                str++;
+
+            value = str;
+
+            if(str < end && *str == '"')
+            {
+                bool escaped = false;
+                int n = 0;
+
+                value = ++str;
+
+                while(str < end && *str != '\n' && *str != '\r' && *str != ';' && *str != '"')
+                {
+                    char c = *str;
+
+                    if(c == '\\')
+                    {
+                        const char *run = str;
+
+                        if(++str == end)
+                            return Error{CE_INI_ERROR_ESCAPE, run};
+
+                        switch(*(str++))
+                        {
+                            case '"':  c = '"';  break;
+                            case '\\': c = '\\'; break;
+                            case 't':  c = '\t'; break;
+                            case 'n':  c = '\n'; break;
+                            default: return Error{CE_INI_ERROR_ESCAPE, run};
+                        }
+
+                        escaped = true;
+                    }
+                    else if(!isQuotedChar(*(str++)))
+                    {
+                        return Error{CE_INI_ERROR_CHARACTER, str - 1};
+                    }
+
+                    if(n < CE_INI_MAX_VALUE_LENGTH - 1)
+                        unescaped[n] = c;
+                    else if(escaped)
+                        return Error{CE_INI_ERROR_LENGTH, str - 1};
+
+                    n++;
+                }
+
+                value_length = n;
+
+                if(str < end && *(str++) != '"')
+                    return Error{CE_INI_ERROR_SYNTAX, str - 1};
+
+                if(escaped)
+                    value = unescaped;
+            }
+            else
+            {
+                while(str < end && isValueChar(*str))
+                    str++;
+
+                if(str < end && *str != '\n' && *str != '\r' && *str != ';')
+                    return Error{CE_INI_ERROR_CHARACTER, str};
+
+                value_length = (int)(str - value);
+
+                while(value_length > 0 && value[value_length - 1] == ' ')
+                    value_length--;
+            }
+
+            if(!(name_length < CE_INI_MAX_NAME_LENGTH))
+                return Error{CE_INI_ERROR_LENGTH, name};
+
+            if(!(value_length < CE_INI_MAX_VALUE_LENGTH))
+                return Error{CE_INI_ERROR_LENGTH, value};
+
+            out.add(section, section_length, name, name_length, value, value_length);
         }
     }
 
-    return CE_INI_OK;
+    return Error{CE_INI_ERROR_NONE, nullptr};
 }
 
-/*----------------------------------------------------------------------------
- * INI Writing
- *---------------------------------------------------------------------------*/
+/* First pass, the sizes of the table and the position of an error. */
+struct Measure
+{
+    size_t count;
+    size_t size;
+    int    code;
+    int    line;
+    int    column;
 
-static int  getWritten(int index, char *written) { return (written[index / 8] >> (index % 8)) & 0x1;   }
-static void setWritten(int index, char *written) {         written[index / 8] |= (0x1 << (index % 8)); }
+    constexpr void add(const char *, int section_length, const char *, int name_length, const char *, int value_length)
+    {
+        count++;
+        size += section_length + name_length + value_length + 3;
+    }
+};
 
-static int bufferPrint(char *buffer, int length, int *bytes_written, const char *str)
+constexpr Measure measure(const char *text, size_t length)
 {
-    int index = *bytes_written;
+    Measure result = {};
+    Error error = parse(text, length, result);
 
-    while(*str)
+    if((result.code = error.code) != CE_INI_ERROR_NONE)
     {
-        if(index < length - 1)
-            buffer[index++] = *(str++);
-        else
-            return err_i("write buffer full\n", CE_INI_ERROR);
+        const char *line_start = text;
+
+        result.line = 1;
+
+        for(const char *str = text; str < error.at; str++)
+        {
+            if(*str == '\n')
+            {
+                line_start = str + 1;
+                result.line++;
+            }
+        }
+
+        result.column = (int)(error.at - line_start) + 1;
     }
 
-    buffer[index + 1] = '\0';
-    *bytes_written = index;
+    return result;
+}
 
-    return CE_INI_OK;
+/* Fails with the error code, line and column as template arguments. */
+template <int Code, int Line, int Column>
+struct CheckText
+{
+    static_assert(Code == CE_INI_ERROR_NONE, "invalid INI text, see the CE_INI_ERROR_* code, line and column in CheckText<>");
+    static constexpr bool ok = true;
+};
+
+/* Index of at least twice as many slots as pairs. */
+constexpr size_t tableSize(size_t count)
+{
+    size_t size = 1;
+    while(size < count * 2)
+        size *= 2;
+    return size;
 }
 
-int CE_INI_Write(char *buffer, int max_length, int option_count, INIWriteCallback callback, void *userdata)
+struct Entry
 {
-    char write_section[CE_INI_MAX_SECTION_LENGTH];
-    char section[CE_INI_MAX_SECTION_LENGTH];
-    char name[CE_INI_MAX_NAME_LENGTH];
-    char value[CE_INI_MAX_VALUE_LENGTH];
-    char written[CE_INI_MAX_WRITE_OPTIONS / 8] = {0};
-    int  bytes_written = 0;
-    int  num_written = 0;
+    size_t   section;
+    size_t   name;
+    size_t   value;
+    int      section_length;
+    int      name_length;
+    int      value_length;
+    unsigned hash;
+};
 
-    CE_INI_ASSERT(callback != NULL);
+} // namespace detail
+
+/* Pairs in the order of the text and an open addressing index on (section,
+   name) built by parse(). Later duplicates replace earlier values in the
+   index, like in CE_INI_Doc. */
+template <size_t Count, size_t Size>
+struct Table
+{
+    static constexpr size_t table_size = detail::tableSize(Count);
 
-    if(option_count > CE_INI_MAX_WRITE_OPTIONS)
-        return err_i("too many write options", CE_INI_ERROR);
+    detail::Entry entries[Count ? Count : 1];
+    size_t        entry_count;
+    size_t        slots[table_size];
+    char          strings[Size ? Size : 1];
+    size_t        strings_length;
 
-    do
+    constexpr size_t size() const
+    {
+        return entry_count;
+    }
+
+    constexpr Pair operator[](size_t index) const
+    {
+        const detail::Entry &entry = entries[index];
+
+        return Pair{strings + entry.section, entry.section_length,
+                    strings + entry.name,    entry.name_length,
+                    strings + entry.value,   entry.value_length};
+    }
+
+    /* Returns the value of name in section, or NULL. */
+    constexpr const char* get(const char *section, const char *name) const
     {
-        num_written = 0;
-        int section_found = 0;
+        size_t section_length = detail::length(section);
+        size_t name_length = detail::length(name);
+        unsigned hash = detail::hashPair(section, section_length, name, name_length);
 
-        for(int i = 0; i < option_count && !section_found; i++)
+        for(size_t slot = hash & (table_size - 1); slots[slot] != 0; slot = (slot + 1) & (table_size - 1))
         {
-            if(getWritten(i, written) == 0)
+            const detail::Entry &entry = entries[slots[slot] - 1];
+
+            if(entry.hash == hash &&
+               (size_t)entry.section_length == section_length && detail::equals(strings + entry.section, section, section_length) &&
+               (size_t)entry.name_length == name_length && detail::equals(strings + entry.name, name, name_length))
             {
-                (*callback)(i, write_section, name, value, userdata);
-                section_found = 1;
+                return strings + entry.value;
             }
         }
 
-        if(section_found)
+        return nullptr;
+    }
+
+    /* Passes every pair to handler like ce::ini::read. */
+    template <typename Handler>
+    constexpr void read(Handler &&handler) const
+    {
+        for(size_t i = 0; i < entry_count; i++)
         {
-            if(bufferPrint(buffer, max_length, &bytes_written, "[")           == CE_INI_ERROR ||
-               bufferPrint(buffer, max_length, &bytes_written, write_section) == CE_INI_ERROR ||
-               bufferPrint(buffer, max_length, &bytes_written, "]\n")         == CE_INI_ERROR)
-            {
-                return err_i("failed to write section\n", CE_INI_ERROR);
-            }
+            const detail::Entry &entry = entries[i];
+
+            handler(strings + entry.section, entry.section_length,
+                    strings + entry.name,    entry.name_length,
+                    strings + entry.value,   entry.value_length);
         }
+    }
 
-        for(int i = 0; i < option_count; i++)
-        {
-            if(getWritten(i, written) == 1)
-                continue;
+    constexpr size_t addString(const char *str, int length)
+    {
+        size_t offset = strings_length;
 
-            (*callback)(i, section, name, value, userdata);
+        for(int i = 0; i < length; i++)
+            strings[strings_length++] = str[i];
+        strings[strings_length++] = '\0';
 
-            if(strcmp(section, write_section) != 0)
-                continue;
+        return offset;
+    }
+
+    constexpr void add(const char *section, int section_length, const char *name, int name_length, const char *value, int value_length)
+    {
+        detail::Entry &entry = entries[entry_count];
+        size_t slot;
 
-            if(bufferPrint(buffer, max_length, &bytes_written, name)    == CE_INI_ERROR ||
-               bufferPrint(buffer, max_length, &bytes_written, "=")     == CE_INI_ERROR ||
-               bufferPrint(buffer, max_length, &bytes_written, value)   == CE_INI_ERROR ||
-               bufferPrint(buffer, max_length, &bytes_written, "\n")    == CE_INI_ERROR)
+        entry.section        = addString(section, section_length);
+        entry.section_length = section_length;
+        entry.name           = addString(name, name_length);
+        entry.name_length    = name_length;
+        entry.value          = addString(value, value_length);
+        entry.value_length   = value_length;
+        entry.hash           = detail::hashPair(section, section_length, name, name_length);
+
+        for(slot = entry.hash & (table_size - 1); slots[slot] != 0; slot = (slot + 1) & (table_size - 1))
+        {
+            const detail::Entry &other = entries[slots[slot] - 1];
+
+            if(other.hash == entry.hash &&
+               other.section_length == section_length && detail::equals(strings + other.section, section, section_length) &&
+               other.name_length == name_length && detail::equals(strings + other.name, name, name_length))
             {
-                return err_i("failed to write name value pair\n", CE_INI_ERROR);
+                break;
             }
-
-            setWritten(i, written);
-            num_written++;
         }
 
-        if(bufferPrint(buffer, max_length, &bytes_written, "\n") == CE_INI_ERROR)
-            return err_i("failed to write\n", CE_INI_ERROR);
+        slots[slot] = ++entry_count;
     }
-    while(num_written > 0);
+};
 
-    return CE_INI_OK;
+/* Parses text at compile time. Errors fail the build through
+   detail::CheckText. */
+template <detail::Literal Text>
+consteval auto parse()
+{
+    constexpr detail::Measure measure = detail::measure(Text.text, sizeof(Text.text) - 1);
+
+    static_assert(detail::CheckText<measure.code, measure.line, measure.column>::ok);
+
+    Table<measure.count, measure.size> table = {};
+    detail::parse(Text.text, sizeof(Text.text) - 1, table);
+
+    return table;
 }
 
+#endif /* C++20 */
+
+} // namespace ini
+} // namespace ce
+
+#endif /* __cplusplus */
+
+
+#endif /* CE_INI_H */
+
+
+/*============================================================================
+ * IMPLEMENTATION
+ *===========================================================================*/
+#ifdef CE_INI_IMPLEMENTATION
+
+#include <float.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef CE_INI_ASSERT
+#include <assert.h>
+#define CE_INI_ASSERT(x) assert(x)
+#endif
+
+#ifndef CE_INI_MALLOC
+#include <stdlib.h>
+#define CE_INI_MALLOC(size)        malloc(size)
+#define CE_INI_REALLOC(ptr, size)  realloc(ptr, size)
+#define CE_INI_FREE(ptr)           free(ptr)
+#else
+#define CE_INI_CUSTOM_ALLOCATOR
+#endif
+
+#if !defined(CE_INI_NO_STDIO) && (defined(__unix__) || defined(__APPLE__))
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CE_INI_POSIX
+
+/* Neither is declared in strict C modes. */
+#ifdef O_CLOEXEC
+#define CE_INI_O_CLOEXEC O_CLOEXEC
+#else
+#define CE_INI_O_CLOEXEC 0
+#endif
+
+#if (defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 199309L) || defined(__APPLE__)
+#define CE_INI_FCHMOD
+#endif
+#endif
+
+#if !defined(CE_INI_NO_THREADS) && (defined(__unix__) || defined(__APPLE__))
+#include <pthread.h>
+#define CE_INI_PTHREADS
+#endif
+
+#if defined(CE_INI_POSIX) && (defined(__GNUC__) || defined(__clang__))
+#include <poll.h>
+#define CE_INI_STORE
+#define CE_INI_ATOMIC_LOAD(ptr)             __atomic_load_n(ptr, __ATOMIC_SEQ_CST)
+#define CE_INI_ATOMIC_STORE(ptr, value)     __atomic_store_n(ptr, value, __ATOMIC_SEQ_CST)
+#define CE_INI_ATOMIC_RELEASE(ptr, value)   __atomic_store_n(ptr, value, __ATOMIC_RELEASE)
+#define CE_INI_ATOMIC_EXCHANGE(ptr, value)  __atomic_exchange_n(ptr, value, __ATOMIC_SEQ_CST)
+#define CE_INI_ATOMIC_ADD(ptr, value)       __atomic_add_fetch(ptr, value, __ATOMIC_SEQ_CST)
+#define CE_INI_ATOMIC_CLAIM(ptr)            __atomic_exchange_n(ptr, 1, __ATOMIC_SEQ_CST)
+#if defined(__linux__)
+#include <sys/inotify.h>
+#define CE_INI_INOTIFY
+#endif
+#endif
+
+#if defined(__cplusplus) && __cplusplus >= 201103L
+#define CE_INI_THREAD_LOCAL thread_local
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define CE_INI_THREAD_LOCAL _Thread_local
+#elif defined(_MSC_VER)
+#define CE_INI_THREAD_LOCAL __declspec(thread)
+#else
+#define CE_INI_THREAD_LOCAL __thread
+#endif
+
+#ifndef CE_INI_MAX_THREADS
+#define CE_INI_MAX_THREADS 64
+#endif
+
+#ifndef CE_INI_ARENA_BLOCK_SIZE
+#define CE_INI_ARENA_BLOCK_SIZE 65536
+#endif
+
+#ifndef CE_INI_WRITE_BLOCK_SIZE
+#define CE_INI_WRITE_BLOCK_SIZE 65536
+#endif
+
+#ifndef CE_INI_MIN_PARALLEL_SIZE
+#define CE_INI_MIN_PARALLEL_SIZE 65536
+#endif
+
+#if !defined(CE_INI_NO_SIMD)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CE_INI_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CE_INI_SSE2
+#endif
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || defined(_M_X64) || defined(_M_IX86) || defined(_M_ARM64)
+#define CE_INI_SWAR
+#endif
+#endif
+
+
+/*----------------------------------------------------------------------------
+ * Errors
+ *
+ * err() and err_i() only note the error and where it happened, which costs
+ * nothing until something fails. The public function that was called then
+ * reports it once with reportError(), which turns the position into offset,
+ * line and column relative to its text.
+ *---------------------------------------------------------------------------*/
+
+typedef struct
+{
+    int         code;
+    const char *message;
+    const char *at;
+} INIPendingError;
+
+static CE_INI_THREAD_LOCAL INIPendingError ini_error;
+static CE_INI_THREAD_LOCAL CE_INI_Error    ini_last_error;
+
+static CE_INI_THREAD_LOCAL INIErrorCallback ini_error_callback = NULL;
+static CE_INI_THREAD_LOCAL void            *ini_error_userdata = NULL;
+
+void CE_INI_SetErrorCallback(INIErrorCallback callback, void *userdata)
+{
+    ini_error_callback = callback;
+    ini_error_userdata = userdata;
+}
+
+static const char* err(int code, const char *msg, const char *at)
+{
+    ini_error.code    = code;
+    ini_error.message = msg;
+    ini_error.at      = at;
+    return NULL;
+}
+
+static int err_i(int code, const char *msg, int result)
+{
+    err(code, msg, NULL);
+    return result;
+}
+
+/* Takes the pending error and its position in text. offset and line are
+   those of the start of text when it is a piece of a larger input. */
+static void takeError(CE_INI_Error *error, const char *text, size_t length, size_t offset, int line)
+{
+    const char *at = ini_error.at;
+
+    memset(error, 0, sizeof(*error));
+    error->code    = ini_error.code;
+    error->message = ini_error.message;
+
+    if(at && text && at >= text && at <= text + length)
+    {
+        const char *line_start = text;
+        const char *str = text;
+
+        error->line = line + 1;
+
+        while((str = (const char *)memchr(str, '\n', at - str)) != NULL)
+        {
+            line_start = ++str;
+            error->line++;
+        }
+
+        error->offset = offset + (at - text);
+        error->column = (int)(at - line_start) + 1;
+    }
+
+    ini_error.code = CE_INI_ERROR_NONE;
+}
+
+/* Reports the pending error, if there is one. Always returns
+   CE_INI_ERROR. */
+static int reportError(const char *text, size_t length, size_t offset, int line)
+{
+    if(ini_error.code == CE_INI_ERROR_NONE)
+        return CE_INI_ERROR;
+
+    takeError(&ini_last_error, text, length, offset, line);
+
+    if(ini_error_callback)
+        (*ini_error_callback)(&ini_last_error, ini_error_userdata);
+
+    return CE_INI_ERROR;
+}
+
+/*----------------------------------------------------------------------------
+ * Statistics
+ *
+ * Counters go to the stats of the current thread, entry points measure their
+ * own time and subtract what their callbacks took. Without CE_INI_STATS all
+ * of this compiles to nothing.
+ *---------------------------------------------------------------------------*/
+#ifdef CE_INI_STATS
+
+#include <time.h>
+
+static CE_INI_THREAD_LOCAL CE_INI_Stats *ini_stats = NULL;
+
+void CE_INI_SetStats(CE_INI_Stats *stats)
+{
+    ini_stats = stats;
+}
+
+static unsigned long long statsNow(void)
+{
+#if defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ull + (unsigned long long)ts.tv_nsec;
+#elif defined(TIME_UTC)
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (unsigned long long)ts.tv_sec * 1000000000ull + (unsigned long long)ts.tv_nsec;
+#else
+    return (unsigned long long)((double)clock() * (1e9 / CLOCKS_PER_SEC));
+#endif
+}
+
+typedef struct
+{
+    CE_INI_Stats      *stats;
+    unsigned long long start;
+    unsigned long long callback_ns;
+} INIStatsScope;
+
+static void statsEnter(INIStatsScope *scope)
+{
+    scope->stats       = ini_stats;
+    scope->start       = 0;
+    scope->callback_ns = 0;
+
+    if(scope->stats)
+    {
+        scope->start       = statsNow();
+        scope->callback_ns = scope->stats->callback_ns;
+    }
+}
+
+static unsigned long long statsElapsed(const INIStatsScope *scope)
+{
+    return (statsNow() - scope->start) - (scope->stats->callback_ns - scope->callback_ns);
+}
+
+/* Bytes and lines of a span the reader moved over, the last line of the
+   text counts even without a newline. */
+static void statsScan(const char *str, const char *stop, const char *end)
+{
+    if(!ini_stats)
+        return;
+
+    ini_stats->bytes_scanned += stop - str;
+
+    if(stop > str && stop == end && stop[-1] != '\n')
+        ini_stats->lines++;
+
+    while(str < stop && (str = (const char *)memchr(str, '\n', stop - str)) != NULL)
+    {
+        ini_stats->lines++;
+        str++;
+    }
+}
+
+#ifdef CE_INI_PTHREADS
+static void statsMerge(CE_INI_Stats *to, const CE_INI_Stats *from)
+{
+    to->bytes_scanned += from->bytes_scanned;
+    to->lines         += from->lines;
+    to->sections      += from->sections;
+    to->keys          += from->keys;
+    to->comments      += from->comments;
+    to->escapes       += from->escapes;
+}
+#endif
+
+#define CE_INI_STAT(field, n)           do { if(ini_stats) ini_stats->field += (n); } while(0)
+#define CE_INI_STAT_SCAN(str, stop, end) statsScan(str, stop, end)
+#define CE_INI_STAT_ENTER(scope)        INIStatsScope scope; statsEnter(&scope)
+#define CE_INI_STAT_LEAVE(scope, field) do { if(scope.stats) scope.stats->field += statsElapsed(&scope); } while(0)
+#define CE_INI_STAT_CALL(call)          do { unsigned long long stat_start = ini_stats ? statsNow() : 0; call; if(ini_stats) ini_stats->callback_ns += statsNow() - stat_start; } while(0)
+
+#else
+
+#define CE_INI_STAT(field, n)            ((void)0)
+#define CE_INI_STAT_SCAN(str, stop, end) ((void)0)
+#define CE_INI_STAT_ENTER(scope)         ((void)0)
+#define CE_INI_STAT_LEAVE(scope, field)  ((void)0)
+#define CE_INI_STAT_CALL(call)           call
+
+#endif /* CE_INI_STATS */
+
+/*----------------------------------------------------------------------------
+ * Character Scanning
+ *
+ * Each scanner returns the first character that does not belong to its class
+ * (or end). The caller then decides whether that character is a delimiter or
+ * an error. With SSE2 or AVX2 available at compile time whole blocks are
+ * classified with vector compares, define CE_INI_NO_SIMD to force the scalar
+ * version.
+ *---------------------------------------------------------------------------*/
+
+#define CE_INI_CHAR_WHITESPACE 0x01 /* control characters and space */
+#define CE_INI_CHAR_VALUE      0x02 /* printable except ';', and tab  */
+#define CE_INI_CHAR_QUOTED     0x04 /* value except '"' and '\\'      */
+#define CE_INI_CHAR_NAME       0x08 /* alphanumeric and ".-_"         */
+#define CE_INI_CHAR_SECTION    0x10 /* alphanumeric and "-_ "         */
+
+/* ASCII only, independent of the current locale. Bytes above 0x7F belong to
+   no class. */
+static const unsigned char char_classes[256] =
+{
+    /* 0x00 */ 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x07, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+    /* 0x10 */ 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+    /* 0x20 */ 0x17, 0x06, 0x02, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x1E, 0x0E, 0x06,
+    /* 0x30 */ 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x06, 0x00, 0x06, 0x06, 0x06, 0x06,
+    /* 0x40 */ 0x06, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E,
+    /* 0x50 */ 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x06, 0x02, 0x06, 0x06, 0x1E,
+    /* 0x60 */ 0x06, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E,
+    /* 0x70 */ 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x06, 0x06, 0x06, 0x06, 0x01,
+    /* 0x80 */ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /* 0x90 */ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /* 0xA0 */ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /* 0xB0 */ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /* 0xC0 */ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /* 0xD0 */ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /* 0xE0 */ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    /* 0xF0 */ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+#define isCharClass(c, mask) (char_classes[(unsigned char)(c)] & (mask))
+
+static int isValueChar(char c)   { return isCharClass(c, CE_INI_CHAR_VALUE);   }
+static int isQuotedChar(char c)  { return isCharClass(c, CE_INI_CHAR_QUOTED);  }
+static int isNameChar(char c)    { return isCharClass(c, CE_INI_CHAR_NAME);    }
+static int isSectionChar(char c) { return isCharClass(c, CE_INI_CHAR_SECTION); }
+
+#if defined(CE_INI_AVX2) || defined(CE_INI_SSE2)
+
+#if defined(CE_INI_AVX2)
+typedef __m256i INIVec;
+#define CE_INI_VEC_WIDTH    32
+#define CE_INI_VEC_MASK     0xFFFFFFFFu
+#define iniVecLoad(p)       _mm256_loadu_si256((const __m256i *)(p))
+#define iniVecSet(c)        _mm256_set1_epi8(c)
+#define iniVecEq(a, b)      _mm256_cmpeq_epi8(a, b)
+#define iniVecOr(a, b)      _mm256_or_si256(a, b)
+#define iniVecAndNot(a, b)  _mm256_andnot_si256(a, b)
+#define iniVecSub(a, b)     _mm256_sub_epi8(a, b)
+#define iniVecSubSat(a, b)  _mm256_subs_epu8(a, b)
+#define iniVecZero()        _mm256_setzero_si256()
+#define iniVecMask(v)       ((unsigned)_mm256_movemask_epi8(v))
+#else
+typedef __m128i INIVec;
+#define CE_INI_VEC_WIDTH    16
+#define CE_INI_VEC_MASK     0xFFFFu
+#define iniVecLoad(p)       _mm_loadu_si128((const __m128i *)(p))
+#define iniVecSet(c)        _mm_set1_epi8(c)
+#define iniVecEq(a, b)      _mm_cmpeq_epi8(a, b)
+#define iniVecOr(a, b)      _mm_or_si128(a, b)
+#define iniVecAndNot(a, b)  _mm_andnot_si128(a, b)
+#define iniVecSub(a, b)     _mm_sub_epi8(a, b)
+#define iniVecSubSat(a, b)  _mm_subs_epu8(a, b)
+#define iniVecZero()        _mm_setzero_si128()
+#define iniVecMask(v)       ((unsigned)_mm_movemask_epi8(v))
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+static int firstSetBit(unsigned mask) { unsigned long i; _BitScanForward(&i, mask); return (int)i; }
+#else
+static int firstSetBit(unsigned mask) { return __builtin_ctz(mask); }
+#endif
+
+/* Lanes set where lo <= c <= hi. */
+static INIVec iniVecRange(INIVec v, char lo, char hi)
+{
+    INIVec offset = iniVecSub(v, iniVecSet(lo));
+    return iniVecEq(iniVecSubSat(offset, iniVecSet((char)(hi - lo))), iniVecZero());
+}
+
+static INIVec iniVecAlnum(INIVec v)
+{
+    return iniVecOr(iniVecRange(v, '0', '9'), iniVecOr(iniVecRange(v, 'A', 'Z'), iniVecRange(v, 'a', 'z')));
+}
+
+static INIVec iniVecValue(INIVec v)
+{
+    INIVec printable = iniVecOr(iniVecRange(v, ' ', '~'), iniVecEq(v, iniVecSet('\t')));
+    return iniVecAndNot(iniVecEq(v, iniVecSet(';')), printable);
+}
+
+static INIVec iniVecQuoted(INIVec v)
+{
+    INIVec special = iniVecOr(iniVecEq(v, iniVecSet('"')), iniVecEq(v, iniVecSet('\\')));
+    return iniVecAndNot(special, iniVecValue(v));
+}
+
+static INIVec iniVecName(INIVec v)
+{
+    INIVec punct = iniVecOr(iniVecEq(v, iniVecSet('.')), iniVecOr(iniVecEq(v, iniVecSet('-')), iniVecEq(v, iniVecSet('_'))));
+    return iniVecOr(iniVecAlnum(v), punct);
+}
+
+static INIVec iniVecSection(INIVec v)
+{
+    INIVec punct = iniVecOr(iniVecEq(v, iniVecSet(' ')), iniVecOr(iniVecEq(v, iniVecSet('-')), iniVecEq(v, iniVecSet('_'))));
+    return iniVecOr(iniVecAlnum(v), punct);
+}
+
+#define CE_INI_SCAN_BLOCKS(str, end, classify)                              \
+    while((end) - (str) >= CE_INI_VEC_WIDTH)                                \
+    {                                                                       \
+        unsigned mask = iniVecMask(classify(iniVecLoad(str))) ^ CE_INI_VEC_MASK;\
+        if(mask)                                                            \
+            return (str) + firstSetBit(mask);                               \
+        (str) += CE_INI_VEC_WIDTH;                                          \
+    }
+
+#else
+
+#define CE_INI_SCAN_BLOCKS(str, end, classify)
+
+#endif
+
+static const char* scanValueChars(const char *str, const char *end)
+{
+    CE_INI_SCAN_BLOCKS(str, end, iniVecValue)
+    while(str < end && isValueChar(*str))
+        str++;
+    return str;
+}
+
+static const char* scanQuotedChars(const char *str, const char *end)
+{
+    CE_INI_SCAN_BLOCKS(str, end, iniVecQuoted)
+    while(str < end && isQuotedChar(*str))
+        str++;
+    return str;
+}
+
+static const char* scanNameChars(const char *str, const char *end)
+{
+    CE_INI_SCAN_BLOCKS(str, end, iniVecName)
+    while(str < end && isNameChar(*str))
+        str++;
+    return str;
+}
+
+static const char* scanSectionChars(const char *str, const char *end)
+{
+    CE_INI_SCAN_BLOCKS(str, end, iniVecSection)
+    while(str < end && isSectionChar(*str))
+        str++;
+    return str;
+}
+
+/*----------------------------------------------------------------------------
+ * String Skipping
+ *
+ * All scanners take the end of the input instead of relying on a terminating
+ * '\0', so text can be parsed in place from read only or mapped memory.
+ *---------------------------------------------------------------------------*/
+
+static const char* skipWhitespace(const char *str, const char *end)
+{
+    while(str < end && *str != '\n' && isCharClass(*str, CE_INI_CHAR_WHITESPACE))
+        str++;
+    return str;
+}
+
+static const char* skipToFirstReadableChar(const char *str, const char *end)
+{
+    while(str < end && isCharClass(*str, CE_INI_CHAR_WHITESPACE))
+        str++;
+    return str;
+}
+
+static const char* nextLine(const char *str, const char *end)
+{
+    const char *newline = (const char *)memchr(str, '\n', end - str);
+    str = newline ? newline : end;
+
+    while(str < end && *str == '\n')
+        str++;
+
+    return str;
+}
+
+static const char* skipEquality(const char *str, const char *end)
+{
+    str = skipWhitespace(str, end);
+    if(!(str < end && *str == '='))
+        return err(CE_INI_ERROR_SYNTAX, "equality not found", str);
+    return skipWhitespace(++str, end);
+}
+
+/*----------------------------------------------------------------------------
+ * Slices
+ *---------------------------------------------------------------------------*/
+
+typedef struct
+{
+    const char *ptr;
+    int         length;
+} INISlice;
+
+static INISlice makeSlice(const char *start, const char *end)
+{
+    INISlice slice;
+    slice.ptr    = start;
+    slice.length = (int)(end - start);
+    return slice;
+}
+
+static int copySlice(char *out, int max_length, INISlice slice, const char *msg)
+{
+    if(!(slice.length < max_length))
+    {
+        err(CE_INI_ERROR_LENGTH, msg, slice.ptr);
+        return CE_INI_ERROR;
+    }
+
+    memcpy(out, slice.ptr, slice.length);
+    out[slice.length] = '\0';
+
+    return CE_INI_OK;
+}
+
+/*----------------------------------------------------------------------------
+ * Arenas
+ *---------------------------------------------------------------------------*/
+
+struct CE_INI_ArenaBlock
+{
+    CE_INI_ArenaBlock *next;
+    size_t             used;
+    size_t             size;
+};
+
+void CE_INI_ArenaInit(CE_INI_Arena *arena, size_t block_size)
+{
+    CE_INI_ASSERT(arena != NULL);
+
+    arena->blocks     = NULL;
+    arena->block_size = block_size ? block_size : CE_INI_ARENA_BLOCK_SIZE;
+}
+
+/* Returns at least size bytes at the top of the arena without allocating
+   them, arenaCommit then takes as many as were used. */
+static char* arenaReserve(CE_INI_Arena *arena, size_t size)
+{
+    CE_INI_ArenaBlock *block = arena->blocks;
+
+    if(!block || block->size - block->used < size)
+    {
+        size_t block_size = (size > arena->block_size) ? size : arena->block_size;
+
+        if(!(block = (CE_INI_ArenaBlock *)CE_INI_MALLOC(sizeof(CE_INI_ArenaBlock) + block_size)))
+            return NULL;
+
+        block->next   = arena->blocks;
+        block->used   = 0;
+        block->size   = block_size;
+        arena->blocks = block;
+    }
+
+    return (char *)(block + 1) + block->used;
+}
+
+static void arenaCommit(CE_INI_Arena *arena, size_t size)
+{
+    arena->blocks->used += size;
+}
+
+void* CE_INI_ArenaAlloc(CE_INI_Arena *arena, size_t size)
+{
+    const size_t align = sizeof(void *) > sizeof(double) ? sizeof(void *) : sizeof(double);
+    CE_INI_ArenaBlock *block = arena->blocks;
+    char *ptr;
+
+    /* Decoded values are committed with their exact length. */
+    if(block)
+    {
+        size_t used = (block->used + align - 1) & ~(align - 1);
+        block->used = (used < block->size) ? used : block->size;
+    }
+
+    size = (size + align - 1) & ~(align - 1);
+
+    if(!(ptr = arenaReserve(arena, size)))
+        return NULL;
+
+    arenaCommit(arena, size);
+
+    return ptr;
+}
+
+void CE_INI_ArenaFree(CE_INI_Arena *arena)
+{
+    while(arena->blocks)
+    {
+        CE_INI_ArenaBlock *next = arena->blocks->next;
+        CE_INI_FREE(arena->blocks);
+        arena->blocks = next;
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * Section Parsing
+ *---------------------------------------------------------------------------*/
+
+static const char* parseSection(const char *str, const char *end, INISlice *out)
+{
+    const char *start;
+
+    if(!(str < end && *(str++) == '['))
+        return err(CE_INI_ERROR_SYNTAX, "start of section not found", str - 1);
+
+    start = str;
+    str = scanSectionChars(str, end);
+
+    if(str < end && *str != ']')
+        return err(CE_INI_ERROR_CHARACTER, "invalid character in section", str);
+
+    *out = makeSlice(start, str);
+
+    if(!(str < end && *(str++) == ']'))
+        return err(CE_INI_ERROR_SYNTAX, "end of section not found", str);
+
+    return str;
+}
+
+/*----------------------------------------------------------------------------
+ * Name Parsing
+ *---------------------------------------------------------------------------*/
+
+static const char* parseName(const char *str, const char *end, INISlice *out)
+{
+    const char *start = str;
+
+    str = scanNameChars(str, end);
+
+    if(str < end && *str != ' ' && *str != '=')
+        return err(CE_INI_ERROR_CHARACTER, "invalid character in name", str);
+
+    if(str == start)
+        return err(CE_INI_ERROR_LENGTH, "name too short", str);
+
+    *out = makeSlice(start, str);
+
+    return str;
+}
+
+/*----------------------------------------------------------------------------
+ * Value Parsing
+ *---------------------------------------------------------------------------*/
+
+static const char* parseUnquotedValue(const char *str, const char *end, INISlice *out)
+{
+    const char *start = str;
+
+    str = scanValueChars(str, end);
+
+    if(str < end && (*str != '\n' && *str != '\r') && *str != ';')
+        return err(CE_INI_ERROR_CHARACTER, "invalid character in value", str);
+
+    *out = makeSlice(start, str);
+
+    while(out->length > 0 && out->ptr[out->length - 1] == ' ')
+        out->length--;
+
+    return str;
+}
+
+/* Destination of quoted values containing escape sequences. Without an arena
+   they are limited to the fixed buffer. */
+typedef struct
+{
+    CE_INI_Arena *arena;
+    char          buffer[CE_INI_MAX_VALUE_LENGTH];
+} INIUnescaper;
+
+/* Decodes the rest of a quoted value starting at the first escape sequence.
+   The unescaped prefix is in value and is copied in front. */
+static const char* parseEscapedValue(const char *str, const char *end, INIUnescaper *unescaped, INISlice *value)
+{
+    char *out = unescaped->buffer;
+    size_t capacity = CE_INI_MAX_VALUE_LENGTH;
+    size_t n = value->length;
+
+    /* Decoding never grows the value and it cannot continue past the line. */
+    if(unescaped->arena)
+    {
+        const char *line_end = (const char *)memchr(str, '\n', end - str);
+        capacity = n + ((line_end ? line_end : end) - str) + 1;
+
+        if(!(out = arenaReserve(unescaped->arena, capacity)))
+            return err(CE_INI_ERROR_MEMORY, "out of memory", str);
+    }
+
+    if(!(n < capacity))
+        return err(CE_INI_ERROR_LENGTH, "value too long", str);
+
+    memcpy(out, value->ptr, n);
+
+    while(str < end && (*str != '\n' && *str != '\r') && *str != ';' && *str != '"')
+    {
+        const char *run = str;
+        char c = '\0';
+
+        if(*str == '\\')
+        {
+            if(++str == end)
+                return err(CE_INI_ERROR_ESCAPE, "invalid escape sequence", run);
+
+            switch(*(str++))
+            {
+                case '"':  c = '"';  break;
+                case '\\': c = '\\'; break;
+                case 't':  c = '\t'; break;
+                case 'n':  c = '\n'; break;
+                default: return err(CE_INI_ERROR_ESCAPE, "invalid escape sequence", run); break;
+            };
+
+            CE_INI_STAT(escapes, 1);
+
+            if(!(n < capacity - 1))
+                return err(CE_INI_ERROR_LENGTH, "value too long", run);
+
+            out[n++] = c;
+            continue;
+        }
+
+        str = scanQuotedChars(str, end);
+
+        if(str == run)
+            return err(CE_INI_ERROR_CHARACTER, "invalid character in value", str);
+
+        if(!(n + (str - run) < capacity))
+            return err(CE_INI_ERROR_LENGTH, "value too long", run + (capacity - n - 1));
+
+        memcpy(out + n, run, str - run);
+        n += str - run;
+    }
+
+    if(unescaped->arena)
+        arenaCommit(unescaped->arena, n);
+
+    value->ptr    = out;
+    value->length = (int)n;
+
+    return str;
+}
+
+static const char* parseQuotedValue(const char *str, const char *end, INIUnescaper *unescaped, INISlice *out)
+{
+    const char *start;
+
+    if(str < end && *(str++) != '"')
+        return err(CE_INI_ERROR_SYNTAX, "starting quote not found", str - 1);
+
+    start = str;
+    str = scanQuotedChars(str, end);
+
+    *out = makeSlice(start, str);
+
+    if(str < end && *str == '\\')
+    {
+        if(!(str = parseEscapedValue(str, end, unescaped, out)))
+            return NULL;
+    }
+    else if(str < end && (*str != '\n' && *str != '\r') && *str != ';' && *str != '"')
+    {
+        return err(CE_INI_ERROR_CHARACTER, "invalid character in value", str);
+    }
+
+    if(str < end && *(str++) != '"')
+        return err(CE_INI_ERROR_SYNTAX, "ending quote not found", str - 1);
+
+    return str;
+}
+
+static const char* parseValue(const char *str, const char *end, INIUnescaper *unescaped, INISlice *out)
+{
+    return (str < end && *str == '\"') ? parseQuotedValue(str, end, unescaped, out) : parseUnquotedValue(str, end, out);
+}
+
+/*----------------------------------------------------------------------------
+ * INI Parsing
+ *
+ * The reader hands out slices into the source text. Only quoted values which
+ * contain escape sequences are decoded, into the reader's unescaped buffer or
+ * the arena if one is set.
+ *---------------------------------------------------------------------------*/
+
+typedef struct
+{
+    const char  *str;
+    const char  *end;
+    INISlice     section;
+    INISlice     name;
+    INISlice     value;
+    const char  *value_start;
+    INIUnescaper unescaped;
+    int          report_sections;
+} INIReader;
+
+static void readerInit(INIReader *r, const char *text, size_t length)
+{
+    r->str     = text;
+    r->end     = text + length;
+    r->section = makeSlice("", "");
+    r->unescaped.arena = NULL;
+    r->report_sections = 0;
+}
+
+/* Returns 1 when a name value pair was read, 0 at the end of the text and -1
+   on error. With report_sections set it also returns 2 after each section
+   header. */
+static int readPair(INIReader *r)
+{
+    const char *str = r->str;
+    const char *end = r->end;
+
+    while(str < end)
+    {
+        str = skipToFirstReadableChar(str, end);
+
+        if(str == end)
+            break;
+
+        if(*str == '[')
+        {
+            if(!(str = parseSection(str, end, &r->section)))
+                return -1;
+
+            CE_INI_STAT(sections, 1);
+
+            if(r->report_sections)
+            {
+                CE_INI_STAT_SCAN(r->str, str, end);
+                r->str = str;
+                return 2;
+            }
+        }
+        else if(*str == ';')
+        {
+            CE_INI_STAT(comments, 1);
+            str = nextLine(str, end);
+        }
+        else
+        {
+            if(!(str = parseName(str, end, &r->name)))
+                return -1;
+
+            if(!(str = skipEquality(str, end)))
+                return -1;
+
+            r->value_start = str;
+
+            if(!(str = parseValue(str, end, &r->unescaped, &r->value)))
+                return -1;
+
+            CE_INI_STAT(keys, 1);
+            CE_INI_STAT_SCAN(r->str, str, end);
+            r->str = str;
+            return 1;
+        }
+    }
+
+    CE_INI_STAT_SCAN(r->str, str, end);
+    r->str = str;
+    return 0;
+}
+
+int CE_INI_Read(const char *text, INIReadCallback callback, void *userdata)
+{
+    CE_INI_ASSERT(text != NULL);
+
+    return CE_INI_ReadN(text, strlen(text), callback, userdata);
+}
+
+int CE_INI_ReadN(const char *text, size_t length, INIReadCallback callback, void *userdata)
+{
+    CE_INI_ASSERT(callback != NULL);
+
+    char section[CE_INI_MAX_SECTION_LENGTH] = {0};
+    char name[CE_INI_MAX_NAME_LENGTH];
+    char value[CE_INI_MAX_VALUE_LENGTH];
+    INIReader reader;
+    int result;
+
+    CE_INI_STAT_ENTER(scope);
+    readerInit(&reader, text, length);
+    reader.report_sections = 1;
+
+    while((result = readPair(&reader)) > 0)
+    {
+        /* Checked at the header, also when no pair follows. */
+        if(result == 2)
+        {
+            if(copySlice(section, CE_INI_MAX_SECTION_LENGTH, reader.section, "section too long") == CE_INI_ERROR)
+            {
+                result = -1;
+                break;
+            }
+            continue;
+        }
+
+        if(copySlice(name,  CE_INI_MAX_NAME_LENGTH,  reader.name,  "name too long")  == CE_INI_ERROR ||
+           copySlice(value, CE_INI_MAX_VALUE_LENGTH, reader.value, "value too long") == CE_INI_ERROR)
+        {
+            result = -1;
+            break;
+        }
+
+        CE_INI_STAT_CALL((*callback)(section, name, value, userdata));
+    }
+
+    CE_INI_STAT_LEAVE(scope, parse_ns);
+
+    return (result < 0) ? reportError(text, length, 0, 0) : CE_INI_OK;
+}
+
+int CE_INI_ReadEx(const char *text, size_t length, INIReadCallback callback, void *userdata, CE_INI_Error *error)
+{
+    int result = CE_INI_ReadN(text, length, callback, userdata);
+
+    if(error)
+    {
+        if(result == CE_INI_OK)
+            memset(error, 0, sizeof(*error));
+        else
+            *error = ini_last_error;
+    }
+
+    return result;
+}
+
+int CE_INI_ReadSlices(const char *text, size_t length, INIReadSliceCallback callback, void *userdata)
+{
+    CE_INI_ASSERT(callback != NULL);
+
+    INIReader reader;
+    int result;
+
+    CE_INI_STAT_ENTER(scope);
+    readerInit(&reader, text, length);
+
+    while((result = readPair(&reader)) > 0)
+    {
+        CE_INI_STAT_CALL((*callback)(reader.section.ptr, reader.section.length,
+                                     reader.name.ptr,    reader.name.length,
+                                     reader.value.ptr,   reader.value.length,
+                                     userdata));
+    }
+
+    CE_INI_STAT_LEAVE(scope, parse_ns);
+
+    return (result < 0) ? reportError(text, length, 0, 0) : CE_INI_OK;
+}
+
+int CE_INI_ReadArena(const char *text, size_t length, CE_INI_Arena *arena, INIReadSliceCallback callback, void *userdata)
+{
+    CE_INI_ASSERT(arena != NULL);
+    CE_INI_ASSERT(callback != NULL);
+
+    INIReader reader;
+    int result;
+
+    CE_INI_STAT_ENTER(scope);
+    readerInit(&reader, text, length);
+    reader.unescaped.arena = arena;
+
+    while((result = readPair(&reader)) > 0)
+    {
+        CE_INI_STAT_CALL((*callback)(reader.section.ptr, reader.section.length,
+                                     reader.name.ptr,    reader.name.length,
+                                     reader.value.ptr,   reader.value.length,
+                                     userdata));
+    }
+
+    CE_INI_STAT_LEAVE(scope, parse_ns);
+
+    return (result < 0) ? reportError(text, length, 0, 0) : CE_INI_OK;
+}
+
+/*----------------------------------------------------------------------------
+ * Cursor
+ *
+ * The reader lives inside the cursor so each step is a plain readPair.
+ *---------------------------------------------------------------------------*/
+
+/* Fails to compile if the reader does not fit into the cursor. */
+typedef char INICursorFits[(sizeof(INIReader) <= sizeof(((CE_INI_Cursor *)0)->reader)) ? 1 : -1];
+
+void CE_INI_CursorInit(CE_INI_Cursor *cursor, const char *text, size_t length)
+{
+    CE_INI_ASSERT(cursor != NULL);
+
+    memset(cursor, 0, sizeof(*cursor));
+    cursor->section = "";
+    cursor->text    = text;
+    cursor->length  = length;
+    readerInit((INIReader *)&cursor->reader, text, length);
+}
+
+int CE_INI_Next(CE_INI_Cursor *cursor)
+{
+    INIReader *reader = (INIReader *)&cursor->reader;
+    int result;
+
+    if((result = readPair(reader)) <= 0)
+    {
+        if(result < 0)
+            reportError(cursor->text, cursor->length, 0, 0);
+        return result;
+    }
+
+    cursor->section        = reader->section.ptr;
+    cursor->section_length = reader->section.length;
+    cursor->name           = reader->name.ptr;
+    cursor->name_length    = reader->name.length;
+    cursor->value          = reader->value.ptr;
+    cursor->value_length   = reader->value.length;
+
+    return 1;
+}
+
+/*----------------------------------------------------------------------------
+ * Lenient Parsing
+ *
+ * Sections are reported one at a time so the section can be restored when a
+ * header turns out to be broken. Positions are found from the line of the
+ * previous error on, which keeps many errors linear in the text size.
+ *---------------------------------------------------------------------------*/
+
+static int addDiagnostic(CE_INI_Diagnostics *diagnostics, const char *text, size_t length, size_t offset, int line)
+{
+    if(diagnostics->count == diagnostics->capacity)
+    {
+        size_t capacity = diagnostics->capacity ? diagnostics->capacity * 2 : 16;
+        CE_INI_Error *grown = (CE_INI_Error *)CE_INI_REALLOC(diagnostics->errors, capacity * sizeof(CE_INI_Error));
+
+        if(!grown)
+            return err_i(CE_INI_ERROR_MEMORY, "out of memory", CE_INI_ERROR);
+
+        diagnostics->errors   = grown;
+        diagnostics->capacity = capacity;
+    }
+
+    takeError(&diagnostics->errors[diagnostics->count++], text, length, offset, line);
+
+    return CE_INI_OK;
+}
+
+int CE_INI_ReadLenient(const char *text, size_t length, INIReadSliceCallback callback, void *userdata, CE_INI_Diagnostics *diagnostics)
+{
+    CE_INI_ASSERT(callback != NULL);
+    CE_INI_ASSERT(diagnostics != NULL);
+
+    const char *end = text + length;
+    const char *line_start = text;
+    size_t first = diagnostics->count;
+    int line = 0;
+    INIReader reader;
+    int result;
+
+    CE_INI_STAT_ENTER(scope);
+    readerInit(&reader, text, length);
+    reader.report_sections = 1;
+
+    for(;;)
+    {
+        INISlice section = reader.section;
+        const char *at;
+
+        if((result = readPair(&reader)) == 0)
+            break;
+
+        if(result == 1)
+        {
+            CE_INI_STAT_CALL((*callback)(reader.section.ptr, reader.section.length,
+                                         reader.name.ptr,    reader.name.length,
+                                         reader.value.ptr,   reader.value.length,
+                                         userdata));
+        }
+
+        if(result > 0)
+            continue;
+
+        /* Only errors without a position in the text (out of memory) end
+           the parse. */
+        at = ini_error.at;
+
+        if(!(at && at >= reader.str && at <= end))
+            break;
+
+        if(addDiagnostic(diagnostics, line_start, end - line_start, line_start - text, line) == CE_INI_ERROR)
+            break;
+
+        line       = diagnostics->errors[diagnostics->count - 1].line - 1;
+        line_start = at - (diagnostics->errors[diagnostics->count - 1].column - 1);
+
+        reader.section = section;
+        at = nextLine(at, end);
+        CE_INI_STAT_SCAN(reader.str, at, end);
+        reader.str = at;
+    }
+
+    CE_INI_STAT_LEAVE(scope, parse_ns);
+
+    if(result < 0 && ini_error.code != CE_INI_ERROR_NONE)
+        return reportError(NULL, 0, 0, 0);
+
+    return (diagnostics->count > first) ? CE_INI_ERROR : CE_INI_OK;
+}
+
+void CE_INI_DiagnosticsFree(CE_INI_Diagnostics *diagnostics)
+{
+    CE_INI_FREE(diagnostics->errors);
+    memset(diagnostics, 0, sizeof(*diagnostics));
+}
+
+/*----------------------------------------------------------------------------
+ * Streaming
+ *
+ * No token spans a newline, so everything up to the last '\n' of the input
+ * seen so far can be parsed exactly like a complete text. Whole lines inside
+ * a chunk are parsed in place, only a partial line at the end of a chunk is
+ * copied and completed by the next one. The current section is copied out
+ * of the chunk before it goes away.
+ *---------------------------------------------------------------------------*/
+
+static int reserve(char **buffer, size_t *capacity, size_t size)
+{
+    char *grown;
+    size_t new_capacity = *capacity ? *capacity : 64;
+
+    if(size <= *capacity)
+        return CE_INI_OK;
+
+    while(new_capacity < size)
+        new_capacity *= 2;
+
+    if(!(grown = (char *)CE_INI_REALLOC(*buffer, new_capacity)))
+        return err_i(CE_INI_ERROR_MEMORY, "out of memory", CE_INI_ERROR);
+
+    *buffer   = grown;
+    *capacity = new_capacity;
+
+    return CE_INI_OK;
+}
+
+static int parserAppend(CE_INI_Parser *parser, const char *chunk, size_t length)
+{
+    if(length == 0)
+        return CE_INI_OK;
+
+    if(reserve(&parser->line, &parser->line_capacity, parser->line_length + length) == CE_INI_ERROR)
+        return CE_INI_ERROR;
+
+    memcpy(parser->line + parser->line_length, chunk, length);
+    parser->line_length += length;
+
+    return CE_INI_OK;
+}
+
+static int parserParse(CE_INI_Parser *parser, const char *text, size_t length)
+{
+    INIReader reader;
+    int result;
+
+    CE_INI_STAT_ENTER(scope);
+    readerInit(&reader, text, length);
+
+    if(parser->section)
+        reader.section = makeSlice(parser->section, parser->section + parser->section_length);
+
+    while((result = readPair(&reader)) > 0)
+    {
+        CE_INI_STAT_CALL((*parser->callback)(reader.section.ptr, reader.section.length,
+                                             reader.name.ptr,    reader.name.length,
+                                             reader.value.ptr,   reader.value.length,
+                                             parser->userdata));
+    }
+
+    CE_INI_STAT_LEAVE(scope, parse_ns);
+
+    if(result < 0)
+        return reportError(text, length, parser->offset, parser->lines);
+
+    if(reader.section.ptr != parser->section)
+    {
+        if(reserve(&parser->section, &parser->section_capacity, reader.section.length + 1) == CE_INI_ERROR)
+            return CE_INI_ERROR;
+
+        memcpy(parser->section, reader.section.ptr, reader.section.length);
+        parser->section_length = reader.section.length;
+    }
+
+    /* Where the next text starts, for error positions. */
+    for(const char *str = text, *end = text + length; (str = (const char *)memchr(str, '\n', end - str)) != NULL; str++)
+        parser->lines++;
+
+    parser->offset += length;
+
+    return CE_INI_OK;
+}
+
+void CE_INI_ParserInit(CE_INI_Parser *parser, INIReadSliceCallback callback, void *userdata)
+{
+    CE_INI_ASSERT(parser != NULL);
+    CE_INI_ASSERT(callback != NULL);
+
+    memset(parser, 0, sizeof(*parser));
+    parser->callback = callback;
+    parser->userdata = userdata;
+}
+
+int CE_INI_Feed(CE_INI_Parser *parser, const char *chunk, size_t length)
+{
+    const char *end = chunk + length;
+    const char *last_line_end = end;
+
+    if(parser->error)
+        return CE_INI_ERROR;
+
+    while(last_line_end > chunk && last_line_end[-1] != '\n')
+        last_line_end--;
+
+    if(last_line_end == chunk)
+    {
+        if(parserAppend(parser, chunk, length) == CE_INI_ERROR)
+            parser->error = reportError(NULL, 0, 0, 0);
+        return parser->error;
+    }
+
+    if(parser->line_length > 0)
+    {
+        const char *newline = (const char *)memchr(chunk, '\n', length);
+
+        if(parserAppend(parser, chunk, newline + 1 - chunk) == CE_INI_ERROR ||
+           parserParse(parser, parser->line, parser->line_length) == CE_INI_ERROR)
+        {
+            parser->error = reportError(NULL, 0, 0, 0);
+            return CE_INI_ERROR;
+        }
+
+        parser->line_length = 0;
+        chunk = newline + 1;
+    }
+
+    if(parserParse(parser, chunk, last_line_end - chunk) == CE_INI_ERROR ||
+       parserAppend(parser, last_line_end, end - last_line_end) == CE_INI_ERROR)
+    {
+        parser->error = reportError(NULL, 0, 0, 0);
+        return CE_INI_ERROR;
+    }
+
+    return CE_INI_OK;
+}
+
+int CE_INI_Finish(CE_INI_Parser *parser)
+{
+    int result = parser->error;
+
+    if(result == CE_INI_OK && parser->line_length > 0 && parserParse(parser, parser->line, parser->line_length) == CE_INI_ERROR)
+        result = reportError(NULL, 0, 0, 0);
+
+    CE_INI_FREE(parser->line);
+    CE_INI_FREE(parser->section);
+    CE_INI_ParserInit(parser, parser->callback, parser->userdata);
+
+    return result;
+}
+
+/*----------------------------------------------------------------------------
+ * Parallel Parsing
+ *
+ * A line starting with '[' always starts a section, and the parser carries no
+ * state across a newline other than the current section, so the text can be
+ * cut in front of any section header and the pieces parsed independently.
+ * Each piece collects its pairs, which are replayed in order afterwards. The
+ * pairs of a piece that failed are replayed up to the error, which is exactly
+ * what a sequential parse would have delivered.
+ *---------------------------------------------------------------------------*/
+#ifdef CE_INI_PTHREADS
+
+typedef struct
+{
+    INISlice section;
+    INISlice name;
+    INISlice value;
+    size_t   unescaped_offset;
+} INIRecord;
+
+typedef struct
+{
+    const char *text;
+    size_t      length;
+    INIRecord  *records;
+    size_t      record_count;
+    size_t      record_capacity;
+    char       *unescaped;
+    size_t      unescaped_length;
+    size_t      unescaped_capacity;
+    int         result;
+    INIPendingError error;
+#ifdef CE_INI_STATS
+    CE_INI_Stats stats;
+#endif
+} INIRange;
+
+static int addRecord(INIRange *range, const INIReader *reader)
+{
+    INIRecord *record;
+
+    if(range->record_count == range->record_capacity)
+    {
+        size_t capacity = range->record_capacity ? range->record_capacity * 2 : 256;
+        INIRecord *grown = (INIRecord *)CE_INI_REALLOC(range->records, capacity * sizeof(INIRecord));
+
+        if(!grown)
+            return err_i(CE_INI_ERROR_MEMORY, "out of memory", CE_INI_ERROR);
+
+        range->records         = grown;
+        range->record_capacity = capacity;
+    }
+
+    record = &range->records[range->record_count++];
+    record->section = reader->section;
+    record->name    = reader->name;
+    record->value   = reader->value;
+
+    /* Unescaped values live in the reader and are overwritten by the next
+       pair, keep an offset since the copy may still move. */
+    if(reader->value.ptr == reader->unescaped.buffer)
+    {
+        if(reserve(&range->unescaped, &range->unescaped_capacity, range->unescaped_length + reader->value.length) == CE_INI_ERROR)
+            return CE_INI_ERROR;
+
+        memcpy(range->unescaped + range->unescaped_length, reader->value.ptr, reader->value.length);
+        record->value.ptr        = NULL;
+        record->unescaped_offset = range->unescaped_length;
+        range->unescaped_length += reader->value.length;
+    }
+
+    return CE_INI_OK;
+}
+
+static void* parseRange(void *arg)
+{
+    INIRange *range = (INIRange *)arg;
+    INIReader reader;
+    int result;
+
+#ifdef CE_INI_STATS
+    /* Counted per range, the caller merges them after the join. */
+    CE_INI_Stats *caller_stats = ini_stats;
+    ini_stats = &range->stats;
+#endif
+
+    readerInit(&reader, range->text, range->length);
+
+    while((result = readPair(&reader)) > 0)
+    {
+        if(addRecord(range, &reader) == CE_INI_ERROR)
+            break;
+    }
+
+    range->result = (result == 0) ? CE_INI_OK : CE_INI_ERROR;
+
+    /* Errors are reported by the calling thread once the pairs in front of
+       them have been passed on. */
+    range->error   = ini_error;
+    ini_error.code = CE_INI_ERROR_NONE;
+
+#ifdef CE_INI_STATS
+    ini_stats = caller_stats;
+#endif
+
+    return NULL;
+}
+
+static const char* findSectionStart(const char *str, const char *end)
+{
+    while(str < end && (str = (const char *)memchr(str, '\n', end - str)) != NULL)
+    {
+        if(++str < end && *str == '[')
+            return str;
+    }
+
+    return end;
+}
+
+#endif /* CE_INI_PTHREADS */
+
+int CE_INI_ReadParallel(const char *text, size_t length, int thread_count, INIReadSliceCallback callback, void *userdata)
+{
+#ifdef CE_INI_PTHREADS
+    INIRange ranges[CE_INI_MAX_THREADS];
+    pthread_t threads[CE_INI_MAX_THREADS];
+    int started[CE_INI_MAX_THREADS];
+    const char *start = text;
+    const char *end = text + length;
+    int range_count = 0;
+    int result = CE_INI_OK;
+
+    CE_INI_ASSERT(callback != NULL);
+
+    if(thread_count > CE_INI_MAX_THREADS)
+        thread_count = CE_INI_MAX_THREADS;
+
+    if(length / CE_INI_MIN_PARALLEL_SIZE < (size_t)thread_count)
+        thread_count = (int)(length / CE_INI_MIN_PARALLEL_SIZE);
+
+    if(thread_count <= 1)
+        return CE_INI_ReadSlices(text, length, callback, userdata);
+
+    CE_INI_STAT_ENTER(scope);
+
+    while(start < end && range_count < thread_count)
+    {
+        const char *split = text + (size_t)(range_count + 1) * (length / thread_count);
+        const char *stop = (range_count + 1 == thread_count) ? end : findSectionStart(split > start ? split - 1 : start, end);
+
+        memset(&ranges[range_count], 0, sizeof(INIRange));
+        ranges[range_count].text   = start;
+        ranges[range_count].length = stop - start;
+        range_count++;
+        start = stop;
+    }
+
+    for(int i = 1; i < range_count; i++)
+        started[i] = pthread_create(&threads[i], NULL, parseRange, &ranges[i]) == 0;
+
+    if(range_count > 0)
+        parseRange(&ranges[0]);
+
+    for(int i = 1; i < range_count; i++)
+    {
+        if(started[i])
+            pthread_join(threads[i], NULL);
+        else
+            parseRange(&ranges[i]);
+    }
+
+    for(int i = 0; i < range_count; i++)
+    {
+        INIRange *range = &ranges[i];
+
+        for(size_t r = 0; r < range->record_count && result == CE_INI_OK; r++)
+        {
+            const INIRecord *record = &range->records[r];
+            const char *value = record->value.ptr ? record->value.ptr : range->unescaped + record->unescaped_offset;
+
+            CE_INI_STAT_CALL((*callback)(record->section.ptr, record->section.length,
+                                         record->name.ptr,    record->name.length,
+                                         value,               record->value.length,
+                                         userdata));
+        }
+
+        if(range->result == CE_INI_ERROR && result == CE_INI_OK)
+        {
+            ini_error = range->error;
+            result = reportError(text, length, 0, 0);
+        }
+
+#ifdef CE_INI_STATS
+        if(scope.stats)
+            statsMerge(scope.stats, &range->stats);
+#endif
+
+        CE_INI_FREE(range->records);
+        CE_INI_FREE(range->unescaped);
+    }
+
+    CE_INI_STAT_LEAVE(scope, parse_ns);
+
+    return result;
+#else
+    (void)thread_count;
+    return CE_INI_ReadSlices(text, length, callback, userdata);
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * File Reading
+ *---------------------------------------------------------------------------*/
+#ifndef CE_INI_NO_STDIO
+
+typedef struct
+{
+    const char *data;
+    size_t      length;
+    int         mapped;
+} INIFile;
+
+#ifdef CE_INI_POSIX
+
+static int openFile(INIFile *file, const char *path)
+{
+    struct stat st;
+    void *data;
+    int fd;
+
+    file->data   = "";
+    file->length = 0;
+    file->mapped = 0;
+
+    if((fd = open(path, O_RDONLY | CE_INI_O_CLOEXEC)) < 0)
+        return err_i(CE_INI_ERROR_IO, "failed to open file", CE_INI_ERROR);
+
+    if(fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return err_i(CE_INI_ERROR_IO, "failed to stat file", CE_INI_ERROR);
+    }
+
+    if(st.st_size == 0)
+    {
+        close(fd);
+        return CE_INI_OK;
+    }
+
+    data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if(data == MAP_FAILED)
+        return err_i(CE_INI_ERROR_IO, "failed to map file", CE_INI_ERROR);
+
+#ifdef MADV_SEQUENTIAL
+    madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+#ifdef MADV_WILLNEED
+    madvise(data, (size_t)st.st_size, MADV_WILLNEED);
+#endif
+
+    file->data   = (const char *)data;
+    file->length = (size_t)st.st_size;
+    file->mapped = 1;
+
+    return CE_INI_OK;
+}
+
+static void closeFile(INIFile *file)
+{
+    if(file->mapped)
+        munmap((void *)file->data, file->length);
+}
+
+#else
+
+static int openFile(INIFile *file, const char *path)
+{
+    FILE *fp;
+    char *data = NULL;
+    size_t capacity = 0;
+
+    file->data   = "";
+    file->length = 0;
+    file->mapped = 0;
+
+    if(!(fp = fopen(path, "rb")))
+        return err_i(CE_INI_ERROR_IO, "failed to open file", CE_INI_ERROR);
+
+    for(;;)
+    {
+        size_t n;
+
+        if(reserve(&data, &capacity, file->length + 65536) == CE_INI_ERROR)
+        {
+            CE_INI_FREE(data);
+            fclose(fp);
+            return CE_INI_ERROR;
+        }
+
+        if((n = fread(data + file->length, 1, capacity - file->length, fp)) == 0)
+            break;
+
+        file->length += n;
+    }
+
+    if(ferror(fp))
+    {
+        CE_INI_FREE(data);
+        fclose(fp);
+        return err_i(CE_INI_ERROR_IO, "failed to read file", CE_INI_ERROR);
+    }
+
+    fclose(fp);
+
+    if(file->length == 0)
+        CE_INI_FREE(data);
+    else
+        file->data = data;
+
+    return CE_INI_OK;
+}
+
+static void closeFile(INIFile *file)
+{
+    if(file->length > 0)
+        CE_INI_FREE((void *)file->data);
+}
+
+#endif /* CE_INI_POSIX */
+
+int CE_INI_ReadFile(const char *path, INIReadCallback callback, void *userdata)
+{
+    INIFile file;
+    int result;
+
+    CE_INI_ASSERT(path != NULL);
+
+    if(openFile(&file, path) == CE_INI_ERROR)
+        return reportError(NULL, 0, 0, 0);
+
+    result = CE_INI_ReadN(file.data, file.length, callback, userdata);
+    closeFile(&file);
+
+    return result;
+}
+
+#endif /* CE_INI_NO_STDIO */
+
+/*----------------------------------------------------------------------------
+ * Documents
+ *
+ * All strings are '\0' terminated and addressed by offset into doc->strings
+ * so the arena can grow by reallocation. Offset 0 holds an empty string, an
+ * entry with name 0 is an empty slot. Sections and names are interned while
+ * loading through a temporary set of offsets.
+ *---------------------------------------------------------------------------*/
+
+#define CE_INI_HASH_BASIS 2166136261u
+#define CE_INI_HASH_PRIME 16777619u
+
+static unsigned hashBytes(unsigned hash, const char *str, size_t length)
+{
+    for(size_t i = 0; i < length; i++)
+        hash = (hash ^ (unsigned char)str[i]) * CE_INI_HASH_PRIME;
+    return hash;
+}
+
+/* Hash of a section to continue with hashBytes over a name. */
+static unsigned hashSection(const char *section, size_t section_length)
+{
+    unsigned hash = hashBytes(CE_INI_HASH_BASIS, section, section_length);
+    return (hash ^ 0xFFu) * CE_INI_HASH_PRIME;
+}
+
+static unsigned hashPair(const char *section, size_t section_length, const char *name, size_t name_length)
+{
+    return hashBytes(hashSection(section, section_length), name, name_length);
+}
+
+static int sliceEquals(INISlice slice, const char *str)
+{
+    return strncmp(str, slice.ptr, slice.length) == 0 && str[slice.length] == '\0';
+}
+
+typedef struct
+{
+    CE_INI_Doc *doc;
+    size_t     *interned;
+    size_t      interned_count;
+    size_t      interned_size;
+    int         result;
+} INIDocLoader;
+
+static int docGrowTable(CE_INI_Doc *doc)
+{
+    size_t size = doc->table_size ? doc->table_size * 2 : 64;
+    CE_INI_DocEntry *entries = (CE_INI_DocEntry *)CE_INI_MALLOC(size * sizeof(CE_INI_DocEntry));
+
+    if(!entries)
+        return err_i(CE_INI_ERROR_MEMORY, "out of memory", CE_INI_ERROR);
+
+    memset(entries, 0, size * sizeof(CE_INI_DocEntry));
+
+    for(size_t i = 0; i < doc->table_size; i++)
+    {
+        size_t slot = doc->entries[i].hash & (size - 1);
+
+        if(doc->entries[i].name == 0)
+            continue;
+
+        while(entries[slot].name != 0)
+            slot = (slot + 1) & (size - 1);
+
+        entries[slot] = doc->entries[i];
+    }
+
+    CE_INI_FREE(doc->entries);
+    doc->entries    = entries;
+    doc->table_size = size;
+
+    return CE_INI_OK;
+}
+
+static int docAddString(CE_INI_Doc *doc, INISlice str, size_t *offset)
+{
+    if(reserve(&doc->strings, &doc->strings_capacity, doc->strings_length + str.length + 1) == CE_INI_ERROR)
+        return CE_INI_ERROR;
+
+    *offset = doc->strings_length;
+    memcpy(doc->strings + doc->strings_length, str.ptr, str.length);
+    doc->strings[doc->strings_length + str.length] = '\0';
+    doc->strings_length += str.length + 1;
+
+    return CE_INI_OK;
+}
+
+static int docIntern(INIDocLoader *loader, INISlice str, size_t *offset)
+{
+    CE_INI_Doc *doc = loader->doc;
+    unsigned hash = hashBytes(CE_INI_HASH_BASIS, str.ptr, str.length);
+    size_t slot;
+
+    if(str.length == 0)
+    {
+        *offset = 0;
+        return CE_INI_OK;
+    }
+
+    if((loader->interned_count + 1) * 4 > loader->interned_size * 3)
+    {
+        size_t size = loader->interned_size ? loader->interned_size * 2 : 64;
+        size_t *interned = (size_t *)CE_INI_MALLOC(size * sizeof(size_t));
+
+        if(!interned)
+            return err_i(CE_INI_ERROR_MEMORY, "out of memory", CE_INI_ERROR);
+
+        memset(interned, 0, size * sizeof(size_t));
+
+        for(size_t i = 0; i < loader->interned_size; i++)
+        {
+            const char *old = doc->strings + loader->interned[i];
+
+            if(loader->interned[i] == 0)
+                continue;
+
+            slot = hashBytes(CE_INI_HASH_BASIS, old, strlen(old)) & (size - 1);
+            while(interned[slot] != 0)
+                slot = (slot + 1) & (size - 1);
+            interned[slot] = loader->interned[i];
+        }
+
+        CE_INI_FREE(loader->interned);
+        loader->interned      = interned;
+        loader->interned_size = size;
+    }
+
+    slot = hash & (loader->interned_size - 1);
+
+    while(loader->interned[slot] != 0)
+    {
+        if(sliceEquals(str, doc->strings + loader->interned[slot]))
+        {
+            *offset = loader->interned[slot];
+            return CE_INI_OK;
+        }
+        slot = (slot + 1) & (loader->interned_size - 1);
+    }
+
+    if(docAddString(doc, str, offset) == CE_INI_ERROR)
+        return CE_INI_ERROR;
+
+    loader->interned[slot] = *offset;
+    loader->interned_count++;
+
+    return CE_INI_OK;
+}
+
+static void docLoadPair(const char *section, int section_length, const char *name, int name_length, const char *value, int value_length, void *userdata)
+{
+    INIDocLoader *loader = (INIDocLoader *)userdata;
+    CE_INI_Doc *doc = loader->doc;
+    INISlice section_slice = makeSlice(section, section + section_length);
+    INISlice name_slice = makeSlice(name, name + name_length);
+    unsigned hash = hashPair(section, section_length, name, name_length);
+    CE_INI_DocEntry *entry;
+    size_t slot;
+
+    if(loader->result == CE_INI_ERROR)
+        return;
+
+    if((doc->entry_count + 1) * 4 > doc->table_size * 3 && docGrowTable(doc) == CE_INI_ERROR)
+    {
+        loader->result = CE_INI_ERROR;
+        return;
+    }
+
+    slot = hash & (doc->table_size - 1);
+
+    while((entry = &doc->entries[slot])->name != 0)
+    {
+        if(entry->hash == hash &&
+           sliceEquals(section_slice, doc->strings + entry->section) &&
+           sliceEquals(name_slice, doc->strings + entry->name))
+        {
+            break;
+        }
+        slot = (slot + 1) & (doc->table_size - 1);
+    }
+
+    if(entry->name == 0)
+    {
+        if(docIntern(loader, section_slice, &entry->section) == CE_INI_ERROR ||
+           docIntern(loader, name_slice, &entry->name) == CE_INI_ERROR)
+        {
+            entry->name    = 0;
+            loader->result = CE_INI_ERROR;
+            return;
+        }
+
+        entry->hash = hash;
+        doc->entry_count++;
+    }
+
+    if(docAddString(doc, makeSlice(value, value + value_length), &entry->value) == CE_INI_ERROR)
+        loader->result = CE_INI_ERROR;
+}
+
+int CE_INI_DocLoad(CE_INI_Doc *doc, const char *text, size_t length)
+{
+    INIDocLoader loader;
+    size_t empty;
+
+    CE_INI_ASSERT(doc != NULL);
+
+    memset(doc, 0, sizeof(*doc));
+    memset(&loader, 0, sizeof(loader));
+    loader.doc = doc;
+
+    if(docAddString(doc, makeSlice("", ""), &empty) == CE_INI_ERROR ||
+       CE_INI_ReadSlices(text, length, docLoadPair, &loader) == CE_INI_ERROR ||
+       loader.result == CE_INI_ERROR)
+    {
+        CE_INI_FREE(loader.interned);
+        CE_INI_DocFree(doc);
+        return reportError(NULL, 0, 0, 0);
+    }
+
+    CE_INI_FREE(loader.interned);
+
+    return CE_INI_OK;
+}
+
+const char* CE_INI_Get(const CE_INI_Doc *doc, const char *section, const char *name)
+{
+    size_t section_length = strlen(section);
+    size_t name_length = strlen(name);
+    unsigned hash = hashPair(section, section_length, name, name_length);
+    size_t slot;
+
+    if(doc->table_size == 0)
+        return NULL;
+
+    slot = hash & (doc->table_size - 1);
+
+    while(doc->entries[slot].name != 0)
+    {
+        const CE_INI_DocEntry *entry = &doc->entries[slot];
+
+        if(entry->hash == hash &&
+           strcmp(doc->strings + entry->section, section) == 0 &&
+           strcmp(doc->strings + entry->name, name) == 0)
+        {
+            return doc->strings + entry->value;
+        }
+
+        slot = (slot + 1) & (doc->table_size - 1);
+    }
+
+    return NULL;
+}
+
+void CE_INI_DocFree(CE_INI_Doc *doc)
+{
+    CE_INI_FREE(doc->strings);
+    CE_INI_FREE(doc->entries);
+    memset(doc, 0, sizeof(*doc));
+}
+
+/*----------------------------------------------------------------------------
+ * Value Conversion
+ *
+ * Values are converted from their slices without copying and independent of
+ * the locale. Errors point at the start of the value in the text, as quoted
+ * values may have been decoded into a buffer.
+ *---------------------------------------------------------------------------*/
+
+#define CE_INI_MAX_DIGITS 19 /* any 19 digits fit into 64 bits */
+
+static int isDigit(char c)
+{
+    return (unsigned)(unsigned char)c - '0' <= 9;
+}
+
+/* ASCII lower case of letters, other bytes are kept. */
+static char foldCase(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (char)(c | 0x20) : c;
+}
+
+#ifdef CE_INI_SWAR
+
+/* Each of the 8 bytes is '0' to '9'. */
+static int isEightDigits(unsigned long long chunk)
+{
+    return ((chunk & 0xF0F0F0F0F0F0F0F0ull) == 0x3030303030303030ull) &&
+           (((chunk + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) == 0x3030303030303030ull);
+}
+
+/* Value of 8 digits loaded little endian, first digit in the lowest byte.
+   Pairs, then quads, then the halves are combined with one multiply each. */
+static unsigned long long eightDigits(unsigned long long chunk)
+{
+    chunk -= 0x3030303030303030ull;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & 0x000000FF000000FFull) * (100 + (1000000ull << 32))) +
+             (((chunk >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32;
+    return chunk;
+}
+
+#endif
+
+/* Reads up to CE_INI_MAX_DIGITS digits into n, 8 at a time where the slice
+   has enough bytes left. */
+static const char* scanDigits(const char *str, const char *end, unsigned long long *n)
+{
+    const char *start = str;
+    unsigned long long value = 0;
+
+#ifdef CE_INI_SWAR
+    while(end - str >= 8 && (str - start) + 8 <= CE_INI_MAX_DIGITS)
+    {
+        unsigned long long chunk;
+
+        memcpy(&chunk, str, 8);
+
+        if(!isEightDigits(chunk))
+            break;
+
+        value = value * 100000000u + eightDigits(chunk);
+        str += 8;
+    }
+#endif
+
+    while(str < end && (str - start) < CE_INI_MAX_DIGITS && isDigit(*str))
+        value = value * 10 + (unsigned)(*(str++) - '0');
+
+    *n = value;
+
+    return str;
+}
+
+/* Reads an unsigned integer of at most max, with any number of leading
+   zeros. A 20th digit is taken if the number still fits into 64 bits. */
+static const char* scanUnsigned(const char *str, const char *end, const char *at, unsigned long long max, unsigned long long *n)
+{
+    if(!(str < end && isDigit(*str)))
+        return err(CE_INI_ERROR_VALUE, "digit expected", at);
+
+    while(end - str > 1 && *str == '0' && isDigit(str[1]))
+        str++;
+
+    str = scanDigits(str, end, n);
+
+    if(str < end && isDigit(*str))
+    {
+        unsigned digit = (unsigned)(*str - '0');
+
+        if(*n > (ULLONG_MAX - digit) / 10)
+            return err(CE_INI_ERROR_RANGE, "number out of range", at);
+
+        *n = *n * 10 + digit;
+        str++;
+    }
+
+    if((str < end && isDigit(*str)) || *n > max)
+        return err(CE_INI_ERROR_RANGE, "number out of range", at);
+
+    return str;
+}
+
+static int convertInteger(INISlice value, const char *at, long long min, long long max, long long *out)
+{
+    const char *str = value.ptr;
+    const char *end = value.ptr + value.length;
+    unsigned long long limit = (unsigned long long)max;
+    unsigned long long n;
+    int negative = 0;
+
+    if(str < end && (*str == '-' || *str == '+'))
+        negative = (*(str++) == '-');
+
+    if(negative)
+        limit = (unsigned long long)-(min + 1) + 1;
+
+    if(!(str = scanUnsigned(str, end, at, limit, &n)))
+        return CE_INI_ERROR;
+
+    if(str != end)
+    {
+        err(CE_INI_ERROR_VALUE, "invalid integer", at);
+        return CE_INI_ERROR;
+    }
+
+    *out = (negative && n) ? -(long long)(n - 1) - 1 : (long long)n;
+
+    return CE_INI_OK;
+}
+
+/* Powers of ten up to 1e22 are exact doubles, so are integers up to 2^53.
+   Their product or quotient is then correctly rounded. */
+static const double powers_of_ten[] =
+{
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/* Numbers with more digits or larger exponents go through strtod. It gets
+   the digits without the '.' and an adjusted exponent, so the decimal point
+   of the current locale does not matter. The value has been checked by
+   convertDouble. */
+static int convertDoubleSlow(INISlice value, const char *at, double *out)
+{
+    char buffer[2 * CE_INI_MAX_VALUE_LENGTH];
+    char *number = buffer;
+    const char *str = value.ptr;
+    const char *end = value.ptr + value.length;
+    size_t capacity = (size_t)value.length + 24;
+    size_t length = 0;
+    long long exponent = 0;
+    long long power = 1;
+    char *number_end;
+    int valid;
+
+    if(capacity > sizeof(buffer) && !(number = (char *)CE_INI_MALLOC(capacity)))
+    {
+        err(CE_INI_ERROR_MEMORY, "out of memory", at);
+        return CE_INI_ERROR;
+    }
+
+    if(*str == '-' || *str == '+')
+        number[length++] = *(str++);
+
+    for(; str < end && isDigit(*str); str++)
+        number[length++] = *str;
+
+    if(str < end && *str == '.')
+    {
+        for(str++; str < end && isDigit(*str); str++, exponent--)
+            number[length++] = *str;
+    }
+
+    if(str < end)
+    {
+        int exponent_negative = 0;
+        long long e = 0;
+
+        if(*(++str) == '-' || *str == '+')
+            exponent_negative = (*(str++) == '-');
+
+        for(; str < end; str++)
+        {
+            if(e < 1000000000)
+                e = e * 10 + (*str - '0');
+        }
+
+        exponent += exponent_negative ? -e : e;
+    }
+
+    number[length++] = 'e';
+
+    if(exponent < 0)
+    {
+        number[length++] = '-';
+        exponent = -exponent;
+    }
+
+    while(exponent / power >= 10)
+        power *= 10;
+
+    for(; power > 0; power /= 10)
+        number[length++] = (char)('0' + exponent / power % 10);
+
+    number[length] = '\0';
+    *out = strtod(number, &number_end);
+    valid = (number_end == number + length);
+
+    if(number != buffer)
+        CE_INI_FREE(number);
+
+    if(!valid)
+    {
+        err(CE_INI_ERROR_VALUE, "invalid number", at);
+        return CE_INI_ERROR;
+    }
+
+    return CE_INI_OK;
+}
+
+/* Decimal numbers with an optional exponent. The significant digits are
+   collected into an integer and scaled by a power of ten when both are
+   exact, anything else is left to convertDoubleSlow. */
+static int convertDouble(INISlice value, const char *at, double *out)
+{
+    const char *str = value.ptr;
+    const char *end = value.ptr + value.length;
+    unsigned long long mantissa = 0;
+    int negative = 0, digits = 0, significant = 0, exponent = 0, exact = 1;
+    double n;
+
+    if(str < end && (*str == '-' || *str == '+'))
+        negative = (*(str++) == '-');
+
+    for(; str < end && isDigit(*str); str++, digits++)
+    {
+        if(mantissa == 0 && *str == '0')
+            continue;
+
+        if(significant < CE_INI_MAX_DIGITS)
+        {
+            mantissa = mantissa * 10 + (unsigned)(*str - '0');
+            significant++;
+        }
+        else
+        {
+            exact = 0;
+            exponent++;
+        }
+    }
+
+    if(str < end && *str == '.')
+    {
+        for(str++; str < end && isDigit(*str); str++, digits++)
+        {
+            if(significant < CE_INI_MAX_DIGITS)
+            {
+                mantissa = mantissa * 10 + (unsigned)(*str - '0');
+                significant += (mantissa != 0);
+                exponent--;
+            }
+            else
+            {
+                exact = 0;
+            }
+        }
+    }
+
+    if(digits == 0)
+    {
+        err(CE_INI_ERROR_VALUE, "invalid number", at);
+        return CE_INI_ERROR;
+    }
+
+    if(str < end && (*str == 'e' || *str == 'E'))
+    {
+        int exponent_negative = 0;
+        int e = 0;
+
+        if(++str < end && (*str == '-' || *str == '+'))
+            exponent_negative = (*(str++) == '-');
+
+        if(!(str < end && isDigit(*str)))
+        {
+            err(CE_INI_ERROR_VALUE, "invalid number", at);
+            return CE_INI_ERROR;
+        }
+
+        for(; str < end && isDigit(*str); str++)
+        {
+            if(e < 100000)
+                e = e * 10 + (*str - '0');
+        }
+
+        exponent += exponent_negative ? -e : e;
+    }
+
+    if(str != end)
+    {
+        err(CE_INI_ERROR_VALUE, "invalid number", at);
+        return CE_INI_ERROR;
+    }
+
+    if(mantissa == 0)
+    {
+        n = negative ? -0.0 : 0.0;
+    }
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    else if(exact && mantissa <= (1ull << 53) && exponent >= -22 && exponent <= 22)
+    {
+        n = (double)mantissa;
+        n = (exponent < 0) ? n / powers_of_ten[-exponent] : n * powers_of_ten[exponent];
+        n = negative ? -n : n;
+    }
+#endif
+    else if(convertDoubleSlow(value, at, &n) == CE_INI_ERROR)
+    {
+        return CE_INI_ERROR;
+    }
+
+    /* Overflow to infinity or underflow of a non zero number to zero. */
+    if(n > DBL_MAX || n < -DBL_MAX || (n == 0 && mantissa != 0))
+    {
+        err(CE_INI_ERROR_RANGE, "number out of range", at);
+        return CE_INI_ERROR;
+    }
+
+    *out = n;
+
+    return CE_INI_OK;
+}
+
+static int convertBool(INISlice value, const char *at, int *out)
+{
+    static const char *const names[] = { "false", "true", "no", "yes", "off", "on", "0", "1" };
+
+    for(int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++)
+    {
+        int j = 0;
+
+        while(j < value.length && names[i][j] != '\0' && foldCase(value.ptr[j]) == names[i][j])
+            j++;
+
+        if(j == value.length && names[i][j] == '\0')
+        {
+            *out = i & 1;
+            return CE_INI_OK;
+        }
+    }
+
+    err(CE_INI_ERROR_VALUE, "invalid bool", at);
+    return CE_INI_ERROR;
+}
+
+typedef struct
+{
+    const char        *name;
+    unsigned long long scale;
+} INIUnit;
+
+/* Compares case insensitively, so "mb" and "MB" are the same. */
+static const INIUnit size_units[] =
+{
+    { "b",   1ull },
+    { "k",   1ull << 10 }, { "kib", 1ull << 10 }, { "kb", 1000ull },
+    { "m",   1ull << 20 }, { "mib", 1ull << 20 }, { "mb", 1000000ull },
+    { "g",   1ull << 30 }, { "gib", 1ull << 30 }, { "gb", 1000000000ull },
+    { "t",   1ull << 40 }, { "tib", 1ull << 40 }, { "tb", 1000000000000ull }
+};
+
+static const INIUnit duration_units[] =
+{
+    { "ns", 1ull },
+    { "us", 1000ull },
+    { "ms", 1000000ull },
+    { "s",  1000000000ull },
+    { "m",  60000000000ull },
+    { "h",  3600000000000ull },
+    { "d",  86400000000000ull }
+};
+
+/* Finds the unit spelled by the letters at str, NULL if there is none. */
+static const INIUnit* findUnit(const INIUnit *units, int unit_count, const char **str, const char *end)
+{
+    const char *start = *str;
+
+    while(*str < end && foldCase(**str) >= 'a' && foldCase(**str) <= 'z')
+        (*str)++;
+
+    for(int i = 0; i < unit_count; i++)
+    {
+        int j = 0;
+
+        while(start + j < *str && units[i].name[j] != '\0' && foldCase(start[j]) == units[i].name[j])
+            j++;
+
+        if(start + j == *str && units[i].name[j] == '\0')
+            return &units[i];
+    }
+
+    return NULL;
+}
+
+static int convertSize(INISlice value, const char *at, unsigned long long *out)
+{
+    const char *str = value.ptr;
+    const char *end = value.ptr + value.length;
+    const INIUnit *unit;
+    unsigned long long n;
+
+    if(!(str = scanUnsigned(str, end, at, ULLONG_MAX, &n)))
+        return CE_INI_ERROR;
+
+    while(str < end && *str == ' ')
+        str++;
+
+    if(str == end)
+    {
+        *out = n;
+        return CE_INI_OK;
+    }
+
+    if(!(unit = findUnit(size_units, (int)(sizeof(size_units) / sizeof(size_units[0])), &str, end)) || str != end)
+    {
+        err(CE_INI_ERROR_VALUE, "invalid size unit", at);
+        return CE_INI_ERROR;
+    }
+
+    if(n > ULLONG_MAX / unit->scale)
+    {
+        err(CE_INI_ERROR_RANGE, "size out of range", at);
+        return CE_INI_ERROR;
+    }
+
+    *out = n * unit->scale;
+
+    return CE_INI_OK;
+}
+
+/* Sums number and unit pairs like "1h30m", a bare "0" is allowed. */
+static int convertDuration(INISlice value, const char *at, long long *out)
+{
+    const char *str = value.ptr;
+    const char *end = value.ptr + value.length;
+    unsigned long long total = 0;
+
+    if(value.length == 1 && str[0] == '0')
+    {
+        *out = 0;
+        return CE_INI_OK;
+    }
+
+    do
+    {
+        const INIUnit *unit;
+        unsigned long long n;
+
+        if(!(str = scanUnsigned(str, end, at, LLONG_MAX, &n)))
+            return CE_INI_ERROR;
+
+        if(!(unit = findUnit(duration_units, (int)(sizeof(duration_units) / sizeof(duration_units[0])), &str, end)))
+        {
+            err(CE_INI_ERROR_VALUE, "invalid duration unit", at);
+            return CE_INI_ERROR;
+        }
+
+        if(n > (unsigned long long)LLONG_MAX / unit->scale || total > (unsigned long long)LLONG_MAX - n * unit->scale)
+        {
+            err(CE_INI_ERROR_RANGE, "duration out of range", at);
+            return CE_INI_ERROR;
+        }
+
+        total += n * unit->scale;
+    } while(str < end);
+
+    *out = (long long)total;
+
+    return CE_INI_OK;
+}
+
+int CE_INI_ToInt(const char *value, int length, int *out)
+{
+    long long n;
+
+    CE_INI_ASSERT(out != NULL);
+
+    if(convertInteger(makeSlice(value, value + length), value, INT_MIN, INT_MAX, &n) == CE_INI_ERROR)
+        return reportError(value, length, 0, 0);
+
+    *out = (int)n;
+
+    return CE_INI_OK;
+}
+
+int CE_INI_ToLong(const char *value, int length, long long *out)
+{
+    CE_INI_ASSERT(out != NULL);
+
+    if(convertInteger(makeSlice(value, value + length), value, LLONG_MIN, LLONG_MAX, out) == CE_INI_ERROR)
+        return reportError(value, length, 0, 0);
+
+    return CE_INI_OK;
+}
+
+int CE_INI_ToDouble(const char *value, int length, double *out)
+{
+    CE_INI_ASSERT(out != NULL);
+
+    if(convertDouble(makeSlice(value, value + length), value, out) == CE_INI_ERROR)
+        return reportError(value, length, 0, 0);
+
+    return CE_INI_OK;
+}
+
+int CE_INI_ToBool(const char *value, int length, int *out)
+{
+    CE_INI_ASSERT(out != NULL);
+
+    if(convertBool(makeSlice(value, value + length), value, out) == CE_INI_ERROR)
+        return reportError(value, length, 0, 0);
+
+    return CE_INI_OK;
+}
+
+int CE_INI_ToSize(const char *value, int length, unsigned long long *out)
+{
+    CE_INI_ASSERT(out != NULL);
+
+    if(convertSize(makeSlice(value, value + length), value, out) == CE_INI_ERROR)
+        return reportError(value, length, 0, 0);
+
+    return CE_INI_OK;
+}
+
+int CE_INI_ToDuration(const char *value, int length, long long *out)
+{
+    CE_INI_ASSERT(out != NULL);
+
+    if(convertDuration(makeSlice(value, value + length), value, out) == CE_INI_ERROR)
+        return reportError(value, length, 0, 0);
+
+    return CE_INI_OK;
+}
+
+/*----------------------------------------------------------------------------
+ * Schemas
+ *
+ * Bindings are placed by hash and displace. The pair hash picks a bucket and
+ * the buckets, largest first, try seeds until all of their bindings land on
+ * free slots of a table with at least twice as many slots as bindings. When
+ * no seed works the table is doubled. While reading the section is hashed
+ * once and each name continues from its hash.
+ *---------------------------------------------------------------------------*/
+
+#define CE_INI_SCHEMA_MAX_SEED  1024
+#define CE_INI_SCHEMA_MAX_SLOTS (1u << 24)
+
+static unsigned schemaSlot(unsigned hash, unsigned seed, unsigned mask)
+{
+    hash = (hash ^ seed) * 0x9E3779B1u;
+    return (hash ^ (hash >> 16)) & mask;
+}
+
+static int schemaCheckBinding(const CE_INI_Binding *binding)
+{
+    if(!binding->section || !binding->name || !isNameChar(binding->name[0]))
+        return CE_INI_ERROR;
+
+    switch(binding->type)
+    {
+        case CE_INI_TYPE_STRING:   return (binding->size > 0)                           ? CE_INI_OK : CE_INI_ERROR;
+        case CE_INI_TYPE_INT:      return (binding->size == sizeof(int))                ? CE_INI_OK : CE_INI_ERROR;
+        case CE_INI_TYPE_LONG:     return (binding->size == sizeof(long long))          ? CE_INI_OK : CE_INI_ERROR;
+        case CE_INI_TYPE_DOUBLE:   return (binding->size == sizeof(double))             ? CE_INI_OK : CE_INI_ERROR;
+        case CE_INI_TYPE_BOOL:     return (binding->size == sizeof(int))                ? CE_INI_OK : CE_INI_ERROR;
+        case CE_INI_TYPE_SIZE:     return (binding->size == sizeof(unsigned long long)) ? CE_INI_OK : CE_INI_ERROR;
+        case CE_INI_TYPE_DURATION: return (binding->size == sizeof(long long))          ? CE_INI_OK : CE_INI_ERROR;
+        default:                   return CE_INI_ERROR;
+    }
+}
+
+/* Places the bindings of one bucket, listed in order, with the first seed
+   that works. Returns CE_INI_ERROR if none does. */
+static int schemaPlaceBucket(CE_INI_Schema *schema, unsigned bucket, const int *order, int count)
+{
+    for(unsigned seed = 0; seed < CE_INI_SCHEMA_MAX_SEED; seed++)
+    {
+        int placed = 0;
+
+        while(placed < count)
+        {
+            unsigned slot = schemaSlot(schema->hashes[order[placed]], seed, schema->slot_mask);
+
+            if(schema->slots[slot] >= 0)
+                break;
+
+            schema->slots[slot] = order[placed++];
+        }
+
+        if(placed == count)
+        {
+            schema->seeds[bucket] = seed;
+            return CE_INI_OK;
+        }
+
+        while(placed > 0)
+            schema->slots[schemaSlot(schema->hashes[order[--placed]], seed, schema->slot_mask)] = -1;
+    }
+
+    return CE_INI_ERROR;
+}
+
+/* Places all buckets into a table of slot_mask + 1 slots. order holds the
+   bindings sorted by bucket, starts the first of each bucket. */
+static int schemaPlace(CE_INI_Schema *schema, const int *order, const int *starts)
+{
+    int max_count = 0;
+
+    for(unsigned i = 0; i <= schema->slot_mask; i++)
+        schema->slots[i] = -1;
+
+    for(unsigned bucket = 0; bucket <= schema->bucket_mask; bucket++)
+    {
+        if(starts[bucket + 1] - starts[bucket] > max_count)
+            max_count = starts[bucket + 1] - starts[bucket];
+    }
+
+    for(int count = max_count; count > 0; count--)
+    {
+        for(unsigned bucket = 0; bucket <= schema->bucket_mask; bucket++)
+        {
+            if(starts[bucket + 1] - starts[bucket] == count &&
+               schemaPlaceBucket(schema, bucket, order + starts[bucket], count) == CE_INI_ERROR)
+            {
+                return CE_INI_ERROR;
+            }
+        }
+    }
+
+    return CE_INI_OK;
+}
+
+static const CE_INI_Binding* schemaFind(const CE_INI_Schema *schema, unsigned hash, INISlice section, INISlice name)
+{
+    int index = schema->slots[schemaSlot(hash, schema->seeds[hash & schema->bucket_mask], schema->slot_mask)];
+    const CE_INI_Binding *binding;
+
+    if(index < 0 || schema->hashes[index] != hash)
+        return NULL;
+
+    binding = &schema->bindings[index];
+
+    return (sliceEquals(section, binding->section) && sliceEquals(name, binding->name)) ? binding : NULL;
+}
+
+/* Hashes and checks the bindings, sorts them by bucket and places them,
+   doubling the table until every bucket finds a seed. */
+static int schemaBuild(CE_INI_Schema *schema, int *order, int *starts, unsigned slot_count)
+{
+    const CE_INI_Binding *bindings = schema->bindings;
+
+    memset(starts, 0, (schema->bucket_mask + 3) * sizeof(int));
+
+    for(int i = 0; i < schema->binding_count; i++)
+    {
+        if(schemaCheckBinding(&bindings[i]) == CE_INI_ERROR)
+            return err_i(CE_INI_ERROR_ARGUMENT, "invalid binding", CE_INI_ERROR);
+
+        schema->hashes[i] = hashPair(bindings[i].section, strlen(bindings[i].section), bindings[i].name, strlen(bindings[i].name));
+        starts[(schema->hashes[i] & schema->bucket_mask) + 2]++;
+    }
+
+    /* Counting sort by bucket, starts[bucket + 1] is the insert position. */
+    for(unsigned bucket = 0; bucket <= schema->bucket_mask; bucket++)
+        starts[bucket + 2] += starts[bucket + 1];
+
+    for(int i = 0; i < schema->binding_count; i++)
+        order[starts[(schema->hashes[i] & schema->bucket_mask) + 1]++] = i;
+
+    /* Duplicates have the same hash and end up in the same bucket. */
+    for(unsigned bucket = 0; bucket <= schema->bucket_mask; bucket++)
+    {
+        for(int i = starts[bucket]; i < starts[bucket + 1]; i++)
+        {
+            for(int j = starts[bucket]; j < i; j++)
+            {
+                const CE_INI_Binding *a = &bindings[order[i]];
+                const CE_INI_Binding *b = &bindings[order[j]];
+
+                if(strcmp(a->section, b->section) == 0 && strcmp(a->name, b->name) == 0)
+                    return err_i(CE_INI_ERROR_ARGUMENT, "duplicate binding", CE_INI_ERROR);
+            }
+        }
+    }
+
+    for(;;)
+    {
+        int *slots = (int *)CE_INI_REALLOC(schema->slots, slot_count * sizeof(int));
+
+        if(!slots)
+            return err_i(CE_INI_ERROR_MEMORY, "out of memory", CE_INI_ERROR);
+
+        schema->slots     = slots;
+        schema->slot_mask = slot_count - 1;
+
+        if(schemaPlace(schema, order, starts) == CE_INI_OK)
+            return CE_INI_OK;
+
+        if((slot_count *= 2) > CE_INI_SCHEMA_MAX_SLOTS)
+            return err_i(CE_INI_ERROR_ARGUMENT, "bindings could not be hashed", CE_INI_ERROR);
+    }
+}
+
+int CE_INI_SchemaInit(CE_INI_Schema *schema, const CE_INI_Binding *bindings, int binding_count, int flags)
+{
+    unsigned bucket_count = 1;
+    unsigned slot_count = 1;
+    int *order, *starts;
+    int result;
+
+    CE_INI_ASSERT(schema != NULL);
+    CE_INI_ASSERT(bindings != NULL || binding_count == 0);
+
+    memset(schema, 0, sizeof(*schema));
+    schema->bindings      = bindings;
+    schema->binding_count = binding_count;
+    schema->flags         = flags;
+
+    while(bucket_count * 2 < (unsigned)binding_count)
+        bucket_count *= 2;
+
+    while(slot_count < (unsigned)binding_count * 2)
+        slot_count *= 2;
+
+    schema->bucket_mask = bucket_count - 1;
+    schema->hashes      = (unsigned *)CE_INI_MALLOC((binding_count + 1) * sizeof(unsigned));
+    schema->seeds       = (unsigned *)CE_INI_MALLOC(bucket_count * sizeof(unsigned));
+    order               = (int *)CE_INI_MALLOC((binding_count + 1) * sizeof(int));
+    starts              = (int *)CE_INI_MALLOC((bucket_count + 2) * sizeof(int));
+
+    if(!schema->hashes || !schema->seeds || !order || !starts)
+        result = err_i(CE_INI_ERROR_MEMORY, "out of memory", CE_INI_ERROR);
+    else
+        result = schemaBuild(schema, order, starts, slot_count);
+
+    CE_INI_FREE(order);
+    CE_INI_FREE(starts);
+
+    if(result == CE_INI_ERROR)
+    {
+        CE_INI_SchemaFree(schema);
+        return reportError(NULL, 0, 0, 0);
+    }
+
+    return CE_INI_OK;
+}
+
+void CE_INI_SchemaFree(CE_INI_Schema *schema)
+{
+    CE_INI_FREE(schema->hashes);
+    CE_INI_FREE(schema->seeds);
+    CE_INI_FREE(schema->slots);
+    memset(schema, 0, sizeof(*schema));
+}
+
+static int bindValue(const CE_INI_Binding *binding, INISlice value, const char *at, char *field)
+{
+    long long n;
+    int flag;
+
+    switch(binding->type)
+    {
+        case CE_INI_TYPE_STRING:
+            if(!((size_t)value.length < binding->size))
+            {
+                err(CE_INI_ERROR_LENGTH, "value too long", at);
+                return CE_INI_ERROR;
+            }
+            memcpy(field, value.ptr, value.length);
+            field[value.length] = '\0';
+            return CE_INI_OK;
+
+        case CE_INI_TYPE_INT:
+            if(convertInteger(value, at, INT_MIN, INT_MAX, &n) == CE_INI_ERROR)
+                return CE_INI_ERROR;
+            *(int *)field = (int)n;
+            return CE_INI_OK;
+
+        case CE_INI_TYPE_LONG:
+            return convertInteger(value, at, LLONG_MIN, LLONG_MAX, (long long *)field);
+
+        case CE_INI_TYPE_DOUBLE:
+            return convertDouble(value, at, (double *)field);
+
+        case CE_INI_TYPE_BOOL:
+            if(convertBool(value, at, &flag) == CE_INI_ERROR)
+                return CE_INI_ERROR;
+            *(int *)field = flag;
+            return CE_INI_OK;
+
+        case CE_INI_TYPE_SIZE:
+            return convertSize(value, at, (unsigned long long *)field);
+
+        case CE_INI_TYPE_DURATION:
+            return convertDuration(value, at, (long long *)field);
+    }
+
+    return CE_INI_ERROR;
+}
+
+int CE_INI_ReadBound(const char *text, size_t length, const CE_INI_Schema *schema, void *object)
+{
+    const char *hashed_section = NULL;
+    unsigned section_hash = 0;
+    INIReader reader;
+    int result;
+
+    CE_INI_ASSERT(schema != NULL);
+    CE_INI_ASSERT(object != NULL);
+
+    CE_INI_STAT_ENTER(scope);
+    readerInit(&reader, text, length);
+
+    while((result = readPair(&reader)) > 0)
+    {
+        const CE_INI_Binding *binding;
+
+        if(reader.section.ptr != hashed_section)
+        {
+            section_hash   = hashSection(reader.section.ptr, reader.section.length);
+            hashed_section = reader.section.ptr;
+        }
+
+        binding = schemaFind(schema, hashBytes(section_hash, reader.name.ptr, reader.name.length), reader.section, reader.name);
+
+        if(!binding)
+        {
+            if(schema->flags & CE_INI_SCHEMA_IGNORE_UNKNOWN)
+                continue;
+
+            err(CE_INI_ERROR_UNKNOWN, "unknown name", reader.name.ptr);
+            result = -1;
+            break;
+        }
+
+        if(bindValue(binding, reader.value, reader.value_start, (char *)object + binding->offset) == CE_INI_ERROR)
+        {
+            result = -1;
+            break;
+        }
+    }
+
+    CE_INI_STAT_LEAVE(scope, parse_ns);
+
+    return (result < 0) ? reportError(text, length, 0, 0) : CE_INI_OK;
+}
+
+/*----------------------------------------------------------------------------
+ * INI Writing
+ *
+ * Every option is added to a builder exactly once. Its strings are copied
+ * into a pool and it is assigned to a group per distinct section (found
+ * through a hash table), groups are numbered in order of first appearance.
+ * A counting sort by group then gives the output order: sections in order
+ * of their first option, options in the order they were added within their
+ * section.
+ *---------------------------------------------------------------------------*/
+
+typedef struct
+{
+    size_t offset;
+    size_t length;
+} INIPoolString;
+
+struct CE_INI_WriteOption
+{
+    INIPoolString name;
+    INIPoolString value;
+    int           group;
+};
+
+struct CE_INI_WriteGroup
+{
+    INIPoolString section;
+    unsigned      hash;
+    int           count;
+};
+
+static int poolAdd(CE_INI_Builder *builder, const char *str, INIPoolString *out)
+{
+    out->offset = builder->strings_length;
+    out->length = strlen(str);
+
+    if(reserve(&builder->strings, &builder->strings_capacity, builder->strings_length + out->length + 1) == CE_INI_ERROR)
+        return CE_INI_ERROR;
+
+    memcpy(builder->strings + builder->strings_length, str, out->length + 1);
+    builder->strings_length += out->length + 1;
+
+    return CE_INI_OK;
+}
+
+/* Appends measured pieces to the output buffer, keeping it '\0' terminated.
+   Without a buffer only the length is counted. With a flush callback the
+   buffer is a block that is handed to flush when full, pieces larger than
+   the block bypass it. */
+typedef struct
+{
+    char                 *buffer;
+    size_t                capacity;
+    size_t                length;
+    INIWriteFlushCallback flush;
+    void                 *flush_userdata;
+} INIWriter;
+
+static int writerCallFlush(INIWriter *writer, const char *str, size_t length)
+{
+    int result;
+
+    CE_INI_STAT_CALL(result = (*writer->flush)(str, length, writer->flush_userdata));
+
+    if(result == CE_INI_OK)
+        CE_INI_STAT(bytes_written, length);
+
+    return result;
+}
+
+static int writerFlush(INIWriter *writer)
+{
+    if(writer->length > 0 && writerCallFlush(writer, writer->buffer, writer->length) == CE_INI_ERROR)
+        return err_i(CE_INI_ERROR_IO, "failed to flush", CE_INI_ERROR);
+
+    writer->length = 0;
+
+    return CE_INI_OK;
+}
+
+static int writerAppend(INIWriter *writer, const char *str, size_t length)
+{
+    if(!writer->buffer)
+    {
+        writer->length += length;
+        return CE_INI_OK;
+    }
+
+    if(writer->flush)
+    {
+        if(writer->length + length > writer->capacity)
+        {
+            if(writerFlush(writer) == CE_INI_ERROR)
+                return CE_INI_ERROR;
+
+            if(length > writer->capacity)
+                return writerCallFlush(writer, str, length);
+        }
+
+        memcpy(writer->buffer + writer->length, str, length);
+        writer->length += length;
+
+        return CE_INI_OK;
+    }
+
+    if(!(writer->length + length < writer->capacity))
+        return err_i(CE_INI_ERROR_BUFFER, "write buffer full", CE_INI_ERROR);
+
+    memcpy(writer->buffer + writer->length, str, length);
+    writer->length += length;
+    writer->buffer[writer->length] = '\0';
+
+    return CE_INI_OK;
+}
+
+static int writerAppendPooled(INIWriter *writer, const CE_INI_Builder *builder, INIPoolString str)
+{
+    return writerAppend(writer, builder->strings + str.offset, str.length);
+}
+
+static int writeGroups(INIWriter *writer, const CE_INI_Builder *builder, const int *order)
+{
+    const CE_INI_WriteGroup *groups = builder->groups;
+    const CE_INI_WriteOption *options = builder->options;
+    int group_count = builder->group_count;
+    int next = 0;
+
+    for(int g = 0; g < group_count; g++)
+    {
+        if(writerAppend(writer, "[", 1)                        == CE_INI_ERROR ||
+           writerAppendPooled(writer, builder, groups[g].section) == CE_INI_ERROR ||
+           writerAppend(writer, "]\n", 2)                      == CE_INI_ERROR)
+        {
+            return CE_INI_ERROR;
+        }
+
+        for(int end = next + groups[g].count; next < end; next++)
+        {
+            const CE_INI_WriteOption *option = &options[order[next]];
+
+            if(writerAppendPooled(writer, builder, option->name)  == CE_INI_ERROR ||
+               writerAppend(writer, "=", 1)                       == CE_INI_ERROR ||
+               writerAppendPooled(writer, builder, option->value) == CE_INI_ERROR ||
+               writerAppend(writer, "\n", 1)                      == CE_INI_ERROR)
+            {
+                return CE_INI_ERROR;
+            }
+        }
+
+        if(writerAppend(writer, "\n", 1) == CE_INI_ERROR)
+            return CE_INI_ERROR;
+    }
+
+    if(writerAppend(writer, "\n", 1) == CE_INI_ERROR)
+        return CE_INI_ERROR;
+
+    return CE_INI_OK;
+}
+
+int CE_INI_Write(char *buffer, int max_length, int option_count, INIWriteCallback callback, void *userdata)
+{
+    return CE_INI_WriteN(buffer, max_length, NULL, option_count, callback, userdata);
+}
+
+void CE_INI_BuilderInit(CE_INI_Builder *builder, int option_count)
+{
+    CE_INI_ASSERT(builder != NULL);
+
+    memset(builder, 0, sizeof(*builder));
+    builder->option_capacity = (option_count > 0) ? option_count : 0;
+}
+
+static int builderGrow(CE_INI_Builder *builder)
+{
+    /* The first allocation uses the hint from CE_INI_BuilderInit. */
+    if(builder->option_count == builder->option_capacity || !builder->options)
+    {
+        int capacity = builder->options ? builder->option_capacity * 2 : builder->option_capacity;
+        CE_INI_WriteOption *options;
+
+        if(capacity < 16)
+            capacity = 16;
+
+        if(!(options = (CE_INI_WriteOption *)CE_INI_REALLOC(builder->options, capacity * sizeof(CE_INI_WriteOption))))
+            return err_i(CE_INI_ERROR_MEMORY, "out of memory", CE_INI_ERROR);
+
+        builder->options         = options;
+        builder->option_capacity = capacity;
+    }
+
+    if(builder->group_count == builder->group_capacity)
+    {
+        int capacity = builder->group_capacity ? builder->group_capacity * 2 : 16;
+        CE_INI_WriteGroup *groups = (CE_INI_WriteGroup *)CE_INI_REALLOC(builder->groups, capacity * sizeof(CE_INI_WriteGroup));
+
+        if(!groups)
+            return err_i(CE_INI_ERROR_MEMORY, "out of memory", CE_INI_ERROR);
+
+        builder->groups         = groups;
+        builder->group_capacity = capacity;
+    }
+
+    /* Keeps the table at most half full, slots hold group + 1, 0 is empty. */
+    if((size_t)(builder->group_count + 1) * 2 > builder->table_size)
+    {
+        size_t table_size = builder->table_size ? builder->table_size * 2 : 16;
+        int *slots = (int *)CE_INI_MALLOC(table_size * sizeof(int));
+
+        if(!slots)
+            return err_i(CE_INI_ERROR_MEMORY, "out of memory", CE_INI_ERROR);
+
+        memset(slots, 0, table_size * sizeof(int));
+
+        for(int g = 0; g < builder->group_count; g++)
+        {
+            size_t slot = builder->groups[g].hash & (table_size - 1);
+
+            while(slots[slot] != 0)
+                slot = (slot + 1) & (table_size - 1);
+
+            slots[slot] = g + 1;
+        }
+
+        CE_INI_FREE(builder->slots);
+        builder->slots      = slots;
+        builder->table_size = table_size;
+    }
+
+    return CE_INI_OK;
+}
+
+static int builderAdd(CE_INI_Builder *builder, const char *section, const char *name, const char *value)
+{
+    CE_INI_WriteOption *option;
+    unsigned hash;
+    size_t slot;
+
+    if(builderGrow(builder) == CE_INI_ERROR)
+        return CE_INI_ERROR;
+
+    hash = hashBytes(CE_INI_HASH_BASIS, section, strlen(section));
+    slot = hash & (builder->table_size - 1);
+
+    while(builder->slots[slot] != 0)
+    {
+        const CE_INI_WriteGroup *group = &builder->groups[builder->slots[slot] - 1];
+
+        if(group->hash == hash && strcmp(builder->strings + group->section.offset, section) == 0)
+            break;
+
+        slot = (slot + 1) & (builder->table_size - 1);
+    }
+
+    if(builder->slots[slot] == 0)
+    {
+        CE_INI_WriteGroup *group = &builder->groups[builder->group_count];
+
+        if(poolAdd(builder, section, &group->section) == CE_INI_ERROR)
+            return CE_INI_ERROR;
+
+        group->hash  = hash;
+        group->count = 0;
+        builder->slots[slot] = ++builder->group_count;
+    }
+
+    option = &builder->options[builder->option_count];
+    option->group = builder->slots[slot] - 1;
+
+    if(poolAdd(builder, name, &option->name) == CE_INI_ERROR ||
+       poolAdd(builder, value, &option->value) == CE_INI_ERROR)
+    {
+        return CE_INI_ERROR;
+    }
+
+    builder->groups[option->group].count++;
+    builder->option_count++;
+
+    return CE_INI_OK;
+}
+
+int CE_INI_BuilderAdd(CE_INI_Builder *builder, const char *section, const char *name, const char *value)
+{
+    CE_INI_ASSERT(section != NULL && name != NULL && value != NULL);
+
+    return (builderAdd(builder, section, name, value) == CE_INI_OK) ? CE_INI_OK : reportError(NULL, 0, 0, 0);
+}
+
+static int builderWrite(const CE_INI_Builder *builder, INIWriter *writer)
+{
+    /* One allocation for the output order and the counting sort positions. */
+    int *order = (int *)CE_INI_MALLOC((builder->option_count + builder->group_count + 1) * sizeof(int));
+    int *positions;
+    int result;
+
+    if(!order)
+        return err_i(CE_INI_ERROR_MEMORY, "out of memory", CE_INI_ERROR);
+
+    positions = order + builder->option_count;
+
+    for(int g = 0, position = 0; g < builder->group_count; g++)
+    {
+        positions[g] = position;
+        position += builder->groups[g].count;
+    }
+
+    for(int i = 0; i < builder->option_count; i++)
+        order[positions[builder->options[i].group]++] = i;
+
+    result = writeGroups(writer, builder, order);
+
+    CE_INI_FREE(order);
+
+    return result;
+}
+
+static int writerInitSink(INIWriter *writer, INIWriteFlushCallback flush, void *flush_userdata)
+{
+    memset(writer, 0, sizeof(*writer));
+    writer->capacity       = CE_INI_WRITE_BLOCK_SIZE;
+    writer->flush          = flush;
+    writer->flush_userdata = flush_userdata;
+
+    if(!(writer->buffer = (char *)CE_INI_MALLOC(writer->capacity)))
+        return err_i(CE_INI_ERROR_MEMORY, "out of memory", CE_INI_ERROR);
+
+    return CE_INI_OK;
+}
+
+int CE_INI_BuilderSink(const CE_INI_Builder *builder, INIWriteFlushCallback flush, void *flush_userdata)
+{
+    INIWriter writer;
+    int result;
+
+    CE_INI_ASSERT(builder != NULL);
+    CE_INI_ASSERT(flush != NULL);
+
+    CE_INI_STAT_ENTER(scope);
+
+    if((result = writerInitSink(&writer, flush, flush_userdata)) == CE_INI_OK)
+    {
+        result = builderWrite(builder, &writer);
+
+        if(result == CE_INI_OK)
+            result = writerFlush(&writer);
+
+        CE_INI_FREE(writer.buffer);
+    }
+
+    CE_INI_STAT_LEAVE(scope, write_ns);
+
+    return (result == CE_INI_OK) ? CE_INI_OK : reportError(NULL, 0, 0, 0);
+}
+
+void CE_INI_BuilderFree(CE_INI_Builder *builder)
+{
+    CE_INI_FREE(builder->options);
+    CE_INI_FREE(builder->groups);
+    CE_INI_FREE(builder->slots);
+    CE_INI_FREE(builder->strings);
+    memset(builder, 0, sizeof(*builder));
+}
+
+static int writeOptions(INIWriter *writer, int option_count, INIWriteCallback callback, void *userdata)
+{
+    char section[CE_INI_MAX_SECTION_LENGTH];
+    char name[CE_INI_MAX_NAME_LENGTH];
+    char value[CE_INI_MAX_VALUE_LENGTH];
+    CE_INI_Builder builder;
+    int result = CE_INI_OK;
+
+    CE_INI_ASSERT(callback != NULL);
+    CE_INI_ASSERT(option_count >= 0);
+
+    CE_INI_STAT_ENTER(scope);
+    CE_INI_BuilderInit(&builder, option_count);
+
+    for(int i = 0; i < option_count && result == CE_INI_OK; i++)
+    {
+        CE_INI_STAT_CALL((*callback)(i, section, name, value, userdata));
+        result = builderAdd(&builder, section, name, value);
+    }
+
+    if(result == CE_INI_OK)
+        result = builderWrite(&builder, writer);
+
+    CE_INI_BuilderFree(&builder);
+
+    CE_INI_STAT_LEAVE(scope, write_ns);
+
+    return result;
+}
+
+int CE_INI_WriteN(char *buffer, int max_length, int *length, int option_count, INIWriteCallback callback, void *userdata)
+{
+    INIWriter writer;
+    int result;
+
+    memset(&writer, 0, sizeof(writer));
+    writer.buffer   = buffer;
+    writer.capacity = (max_length > 0) ? (size_t)max_length : 0;
+
+    result = writeOptions(&writer, option_count, callback, userdata);
+
+    if(buffer)
+        CE_INI_STAT(bytes_written, writer.length);
+
+    if(length)
+        *length = (int)writer.length;
+
+    return (result == CE_INI_OK) ? CE_INI_OK : reportError(NULL, 0, 0, 0);
+}
+
+int CE_INI_WriteSink(INIWriteFlushCallback flush, void *flush_userdata, int option_count, INIWriteCallback callback, void *userdata)
+{
+    INIWriter writer;
+    int result;
+
+    CE_INI_ASSERT(flush != NULL);
+
+    if(writerInitSink(&writer, flush, flush_userdata) == CE_INI_ERROR)
+        return reportError(NULL, 0, 0, 0);
+
+    result = writeOptions(&writer, option_count, callback, userdata);
+
+    if(result == CE_INI_OK)
+        result = writerFlush(&writer);
+
+    CE_INI_FREE(writer.buffer);
+
+    return (result == CE_INI_OK) ? CE_INI_OK : reportError(NULL, 0, 0, 0);
+}
+
+#ifndef CE_INI_NO_STDIO
+
+static int flushFILE(const char *data, size_t length, void *userdata)
+{
+    return (fwrite(data, 1, length, (FILE *)userdata) == length) ? CE_INI_OK : CE_INI_ERROR;
+}
+
+int CE_INI_WriteFILE(FILE *file, int option_count, INIWriteCallback callback, void *userdata)
+{
+    CE_INI_ASSERT(file != NULL);
+
+    return CE_INI_WriteSink(flushFILE, file, option_count, callback, userdata);
+}
+
+#ifdef CE_INI_POSIX
+
+static int flushFd(const char *data, size_t length, void *userdata)
+{
+    int fd = *(int *)userdata;
+
+    while(length > 0)
+    {
+        ssize_t n = write(fd, data, length);
+
+        if(n < 0 && errno == EINTR)
+            continue;
+
+        if(n <= 0)
+            return CE_INI_ERROR;
+
+        data   += n;
+        length -= (size_t)n;
+    }
+
+    return CE_INI_OK;
+}
+
+int CE_INI_WriteFd(int fd, int option_count, INIWriteCallback callback, void *userdata)
+{
+    return CE_INI_WriteSink(flushFd, &fd, option_count, callback, userdata);
+}
+
+static int syncDirectory(const char *path)
+{
+    const char *slash = strrchr(path, '/');
+    size_t length = slash ? (size_t)(slash - path) + 1 : 1;
+    char *directory;
+    int fd, result;
+
+    if(!(directory = (char *)CE_INI_MALLOC(length + 1)))
+        return CE_INI_ERROR;
+
+    memcpy(directory, slash ? path : ".", length);
+    directory[length] = '\0';
+
+    fd = open(directory, O_RDONLY | CE_INI_O_CLOEXEC);
+    CE_INI_FREE(directory);
+
+    if(fd < 0)
+        return CE_INI_ERROR;
+
+    result = fsync(fd);
+    close(fd);
+
+    return (result == 0) ? CE_INI_OK : CE_INI_ERROR;
+}
+
+int CE_INI_WriteFile(const char *path, int option_count, INIWriteCallback callback, void *userdata)
+{
+    size_t path_length;
+    struct stat st;
+    int exists;
+    mode_t mode;
+    char *temp_path;
+    int fd = -1;
+
+    CE_INI_ASSERT(path != NULL);
+
+    path_length = strlen(path);
+    exists = (stat(path, &st) == 0);
+    mode = exists ? (st.st_mode & 07777) : 0666;
+
+    if(!(temp_path = (char *)CE_INI_MALLOC(path_length + 32)))
+    {
+        err(CE_INI_ERROR_MEMORY, "out of memory", NULL);
+        return reportError(NULL, 0, 0, 0);
+    }
+
+    for(int attempt = 0; fd < 0 && attempt < 100; attempt++)
+    {
+        sprintf(temp_path, "%s.%ld.%d.tmp", path, (long)getpid(), attempt);
+        fd = open(temp_path, O_WRONLY | O_CREAT | O_EXCL | CE_INI_O_CLOEXEC, mode);
+
+        if(fd < 0 && errno != EEXIST)
+            break;
+    }
+
+    if(fd < 0)
+    {
+        CE_INI_FREE(temp_path);
+        err(CE_INI_ERROR_IO, "failed to create temporary file", NULL);
+        return reportError(NULL, 0, 0, 0);
+    }
+
+    /* open applied the umask, a replaced file keeps its exact mode. */
+#ifdef CE_INI_FCHMOD
+    if(exists && fchmod(fd, mode) != 0)
+#else
+    if(exists && chmod(temp_path, mode) != 0)
+#endif
+    {
+        close(fd);
+        unlink(temp_path);
+        CE_INI_FREE(temp_path);
+        err(CE_INI_ERROR_IO, "failed to set file mode", NULL);
+        return reportError(NULL, 0, 0, 0);
+    }
+
+    /* CE_INI_WriteFd reports its own errors. */
+    if(CE_INI_WriteFd(fd, option_count, callback, userdata) == CE_INI_ERROR)
+    {
+        close(fd);
+        unlink(temp_path);
+        CE_INI_FREE(temp_path);
+        return CE_INI_ERROR;
+    }
+
+    if(fsync(fd) != 0)
+    {
+        close(fd);
+        unlink(temp_path);
+        CE_INI_FREE(temp_path);
+        err(CE_INI_ERROR_IO, "failed to write temporary file", NULL);
+        return reportError(NULL, 0, 0, 0);
+    }
+
+    if(close(fd) != 0 || rename(temp_path, path) != 0)
+    {
+        unlink(temp_path);
+        CE_INI_FREE(temp_path);
+        err(CE_INI_ERROR_IO, "failed to replace file", NULL);
+        return reportError(NULL, 0, 0, 0);
+    }
+
+    CE_INI_FREE(temp_path);
+
+    if(syncDirectory(path) == CE_INI_ERROR)
+    {
+        err(CE_INI_ERROR_IO, "failed to sync directory", NULL);
+        return reportError(NULL, 0, 0, 0);
+    }
+
+    return CE_INI_OK;
+}
+
+#endif /* CE_INI_POSIX */
+
+#endif /* CE_INI_NO_STDIO */
+
+/*----------------------------------------------------------------------------
+ * Editing
+ *
+ * Every edit becomes a splice of the original text: a span to drop and the
+ * text to put in its place. Changed values replace the value token, removed
+ * pairs drop their line or just their own span, added pairs are inserted
+ * at the end of the last line of their section. Pairs of sections which do
+ * not exist yet go to the end of the text, grouped under one new header per
+ * section. Saving sorts the splices and streams the text between them
+ * straight from the source.
+ *
+ * Pairs and sections are found through open addressing tables kept at most
+ * half full, slots hold index + 1 and 0 is empty. A pair slot holds the
+ * newest entry of its section and name, older entries of the same pair are
+ * chained through previous. Headers are not indexed.
+ *---------------------------------------------------------------------------*/
+
+#define CE_INI_EDIT_ORIGINAL 0
+#define CE_INI_EDIT_ADDED    1
+#define CE_INI_EDIT_HEADER   2
+
+struct CE_INI_EditorEntry
+{
+    INISlice    section;
+    INISlice    name;
+    unsigned    hash;
+    int         kind;
+    int         removed;
+    int         quoted;
+    size_t      value_start;
+    size_t      value_end;
+    size_t      remove_start;
+    size_t      remove_end;
+    int         group;
+    const char *replacement;
+    size_t      replacement_length;
+    size_t      previous;
+};
+
+struct CE_INI_EditorSection
+{
+    INISlice section;
+    unsigned hash;
+    size_t   insert;
+    int      group;
+};
+
+typedef struct
+{
+    size_t      start;
+    size_t      end;
+    int         group;
+    size_t      sequence;
+    const char *text;
+    size_t      length;
+} INISplice;
+
+static int editorAddEntry(CE_INI_Editor *editor, CE_INI_EditorEntry **entry)
+{
+    if(editor->entry_count == editor->entry_capacity)
+    {
+        size_t capacity = editor->entry_capacity ? editor->entry_capacity * 2 : 64;
+        CE_INI_EditorEntry *grown = (CE_INI_EditorEntry *)CE_INI_REALLOC(editor->entries, capacity * sizeof(CE_INI_EditorEntry));
+
+        if(!grown)
+            return err_i(CE_INI_ERROR_MEMORY, "out of memory", CE_INI_ERROR);
+
+        editor->entries        = grown;
+        editor->entry_capacity = capacity;
+    }
+
+    *entry = &editor->entries[editor->entry_count++];
+    memset(*entry, 0, sizeof(CE_INI_EditorEntry));
+
+    return CE_INI_OK;
+}
+
+static int sliceSame(INISlice a, INISlice b)
+{
+    return a.length == b.length && memcmp(a.ptr, b.ptr, a.length) == 0;
+}
+
+/* Makes room in the pair table for one more entry. */
+static int editorGrowEntrySlots(CE_INI_Editor *editor)
+{
+    size_t table_size;
+    size_t *slots;
+
+    if((editor->entry_count + 1) * 2 <= editor->entry_table_size)
+        return CE_INI_OK;
+
+    table_size = editor->entry_table_size ? editor->entry_table_size * 2 : 128;
+
+    if(!(slots = (size_t *)CE_INI_MALLOC(table_size * sizeof(size_t))))
+        return err_i(CE_INI_ERROR_MEMORY, "out of memory", CE_INI_ERROR);
+
+    memset(slots, 0, table_size * sizeof(size_t));
+
+    /* Only the newest entry of a pair has a slot, the chain moves along. */
+    for(size_t i = 0; i < editor->entry_table_size; i++)
+    {
+        size_t slot;
+
+        if(editor->entry_slots[i] == 0)
+            continue;
+
+        slot = editor->entries[editor->entry_slots[i] - 1].hash & (table_size - 1);
+        while(slots[slot] != 0)
+            slot = (slot + 1) & (table_size - 1);
+        slots[slot] = editor->entry_slots[i];
+    }
+
+    CE_INI_FREE(editor->entry_slots);
+    editor->entry_slots      = slots;
+    editor->entry_table_size = table_size;
+
+    return CE_INI_OK;
+}
+
+/* Slot of the pair, or the empty slot it would go to. */
+static size_t* editorEntrySlot(const CE_INI_Editor *editor, INISlice section, INISlice name, unsigned hash)
+{
+    size_t slot = hash & (editor->entry_table_size - 1);
+
+    while(editor->entry_slots[slot] != 0)
+    {
+        const CE_INI_EditorEntry *entry = &editor->entries[editor->entry_slots[slot] - 1];
+
+        if(entry->hash == hash && sliceSame(entry->section, section) && sliceSame(entry->name, name))
+            break;
+
+        slot = (slot + 1) & (editor->entry_table_size - 1);
+    }
+
+    return &editor->entry_slots[slot];
+}
+
+/* Indexes the last entry, the table must have been grown before adding it. */
+static void editorIndexEntry(CE_INI_Editor *editor)
+{
+    CE_INI_EditorEntry *entry = &editor->entries[editor->entry_count - 1];
+    size_t *slot = editorEntrySlot(editor, entry->section, entry->name, entry->hash);
+
+    entry->previous = *slot;
+    *slot = editor->entry_count;
+}
+
+static CE_INI_EditorSection* editorFindSection(const CE_INI_Editor *editor, INISlice section)
+{
+    unsigned hash = hashBytes(CE_INI_HASH_BASIS, section.ptr, section.length);
+
+    if(editor->section_table_size == 0)
+        return NULL;
+
+    for(size_t slot = hash & (editor->section_table_size - 1); editor->section_slots[slot] != 0; slot = (slot + 1) & (editor->section_table_size - 1))
+    {
+        CE_INI_EditorSection *found = &editor->sections[editor->section_slots[slot] - 1];
+
+        if(found->hash == hash && sliceSame(found->section, section))
+            return found;
+    }
+
+    return NULL;
+}
+
+static int editorGrowSectionSlots(CE_INI_Editor *editor)
+{
+    size_t table_size;
+    size_t *slots;
+
+    if((editor->section_count + 1) * 2 <= editor->section_table_size)
+        return CE_INI_OK;
+
+    table_size = editor->section_table_size ? editor->section_table_size * 2 : 32;
+
+    if(!(slots = (size_t *)CE_INI_MALLOC(table_size * sizeof(size_t))))
+        return err_i(CE_INI_ERROR_MEMORY, "out of memory", CE_INI_ERROR);
+
+    memset(slots, 0, table_size * sizeof(size_t));
+
+    for(size_t i = 0; i < editor->section_count; i++)
+    {
+        size_t slot = editor->sections[i].hash & (table_size - 1);
+
+        while(slots[slot] != 0)
+            slot = (slot + 1) & (table_size - 1);
+        slots[slot] = i + 1;
+    }
+
+    CE_INI_FREE(editor->section_slots);
+    editor->section_slots      = slots;
+    editor->section_table_size = table_size;
+
+    return CE_INI_OK;
+}
+
+/* Records that pairs of section may be inserted at insert. */
+static int editorUpdateSection(CE_INI_Editor *editor, INISlice section, size_t insert, int group)
+{
+    CE_INI_EditorSection *found = editorFindSection(editor, section);
+
+    if(!found)
+    {
+        size_t slot;
+
+        if(editorGrowSectionSlots(editor) == CE_INI_ERROR)
+            return CE_INI_ERROR;
+
+        if(editor->section_count == editor->section_capacity)
+        {
+            size_t capacity = editor->section_capacity ? editor->section_capacity * 2 : 16;
+            CE_INI_EditorSection *grown = (CE_INI_EditorSection *)CE_INI_REALLOC(editor->sections, capacity * sizeof(CE_INI_EditorSection));
+
+            if(!grown)
+                return err_i(CE_INI_ERROR_MEMORY, "out of memory", CE_INI_ERROR);
+
+            editor->sections         = grown;
+            editor->section_capacity = capacity;
+        }
+
+        found = &editor->sections[editor->section_count++];
+        found->section = section;
+        found->hash    = hashBytes(CE_INI_HASH_BASIS, section.ptr, section.length);
+
+        slot = found->hash & (editor->section_table_size - 1);
+        while(editor->section_slots[slot] != 0)
+            slot = (slot + 1) & (editor->section_table_size - 1);
+        editor->section_slots[slot] = editor->section_count;
+    }
+
+    found->insert = insert;
+    found->group  = group;
+
+    return CE_INI_OK;
+}
+
+static size_t lineEnd(const char *text, size_t length, size_t offset)
+{
+    const char *newline = (const char *)memchr(text + offset, '\n', length - offset);
+    return newline ? (size_t)(newline - text) + 1 : length;
+}
+
+static int isBlank(const char *str, const char *end)
+{
+    while(str < end && (*str == ' ' || *str == '\t'))
+        str++;
+    return str == end;
+}
+
+int CE_INI_EditorLoad(CE_INI_Editor *editor, const char *text, size_t length)
+{
+    INIReader reader;
+    int result;
+
+    CE_INI_ASSERT(editor != NULL);
+
+    memset(editor, 0, sizeof(*editor));
+    editor->text   = text;
+    editor->length = length;
+    CE_INI_ArenaInit(&editor->arena, 0);
+
+    CE_INI_STAT_ENTER(scope);
+    readerInit(&reader, text, length);
+    reader.report_sections = 1;
+
+    if(editorUpdateSection(editor, reader.section, 0, 0) == CE_INI_ERROR)
+    {
+        CE_INI_EditorFree(editor);
+        CE_INI_STAT_LEAVE(scope, parse_ns);
+        return reportError(NULL, 0, 0, 0);
+    }
+
+    while((result = readPair(&reader)) > 0)
+    {
+        size_t line_end = lineEnd(text, length, reader.str - text);
+        CE_INI_EditorEntry *entry;
+
+        if(result == 2)
+        {
+            if(editorUpdateSection(editor, reader.section, line_end, 0) == CE_INI_ERROR)
+                break;
+            continue;
+        }
+
+        if(editorUpdateSection(editor, reader.section, line_end, 0) == CE_INI_ERROR ||
+           editorGrowEntrySlots(editor) == CE_INI_ERROR ||
+           editorAddEntry(editor, &entry) == CE_INI_ERROR)
+        {
+            break;
+        }
+
+        entry->section     = reader.section;
+        entry->name        = reader.name;
+        entry->hash        = hashPair(reader.section.ptr, reader.section.length, reader.name.ptr, reader.name.length);
+        entry->kind        = CE_INI_EDIT_ORIGINAL;
+        editorIndexEntry(editor);
+        entry->quoted      = (reader.value_start < text + length && *reader.value_start == '"');
+        entry->value_start = reader.value_start - text;
+        entry->value_end   = entry->quoted ? (size_t)(reader.str - text) : (size_t)(reader.value.ptr + reader.value.length - text);
+
+        /* An empty value of a CRLF line starts after the '\r', a new value
+           goes in front of it. */
+        while(entry->value_end == entry->value_start && entry->value_start > 0 && text[entry->value_start - 1] == '\r')
+        {
+            entry->value_start--;
+            entry->value_end--;
+        }
+
+        /* A pair alone on its line (apart from a comment) is removed with
+           its line, otherwise only the pair itself goes. */
+        {
+            const char *line_start = reader.name.ptr;
+            const char *rest = reader.str;
+
+            while(line_start > text && line_start[-1] != '\n')
+                line_start--;
+
+            while(rest < text + line_end && (*rest == ' ' || *rest == '\t' || *rest == '\r'))
+                rest++;
+
+            if(isBlank(line_start, reader.name.ptr) && (rest == text + line_end || *rest == '\n' || *rest == ';'))
+            {
+                entry->remove_start = line_start - text;
+                entry->remove_end   = line_end;
+            }
+            else
+            {
+                entry->remove_start = reader.name.ptr - text;
+                entry->remove_end   = reader.str - text;
+            }
+        }
+    }
+
+    CE_INI_STAT_LEAVE(scope, parse_ns);
+
+    if(result != 0)
+    {
+        CE_INI_EditorFree(editor);
+        return reportError(text, length, 0, 0);
+    }
+
+    return CE_INI_OK;
+}
+
+/* Newest entry of the pair which is not removed. */
+static CE_INI_EditorEntry* editorFind(const CE_INI_Editor *editor, INISlice section, INISlice name, unsigned hash)
+{
+    if(editor->entry_table_size == 0)
+        return NULL;
+
+    for(size_t index = *editorEntrySlot(editor, section, name, hash); index != 0; index = editor->entries[index - 1].previous)
+    {
+        if(!editor->entries[index - 1].removed)
+            return &editor->entries[index - 1];
+    }
+
+    return NULL;
+}
+
+static char* editorCopy(CE_INI_Editor *editor, const char *str, size_t length)
+{
+    char *copy = (char *)arenaReserve(&editor->arena, length);
+
+    if(copy)
+    {
+        memcpy(copy, str, length);
+        arenaCommit(&editor->arena, length);
+    }
+
+    return copy;
+}
+
+/* Formats value as a value token, quoted if it was quoted before or cannot
+   be written unquoted. */
+static int editorFormatValue(CE_INI_Editor *editor, const char *value, int quoted, const char **out, size_t *out_length)
+{
+    size_t length = strlen(value);
+    size_t n = 0;
+    char *token;
+
+    /* ';' and control characters other than tab can not be written at all,
+       newlines only escaped in quotes. */
+    for(size_t i = 0; i < length; i++)
+    {
+        if(!isCharClass(value[i], CE_INI_CHAR_QUOTED) && value[i] != '"' && value[i] != '\\' && value[i] != '\n')
+            return err_i(CE_INI_ERROR_ARGUMENT, "value can not be written", CE_INI_ERROR);
+
+        if(value[i] == '\n')
+            quoted = 1;
+    }
+
+    if(length > 0 && (value[0] == ' ' || value[0] == '\t' || value[0] == '"' || value[length - 1] == ' '))
+        quoted = 1;
+
+    if(!(token = arenaReserve(&editor->arena, 2 * length + 2)))
+        return err_i(CE_INI_ERROR_MEMORY, "out of memory", CE_INI_ERROR);
+
+    if(quoted)
+        token[n++] = '"';
+
+    for(size_t i = 0; i < length; i++)
+    {
+        char c = value[i];
+
+        if(quoted && (c == '"' || c == '\\' || c == '\t' || c == '\n'))
+        {
+            token[n++] = '\\';
+            c = (c == '\t') ? 't' : (c == '\n') ? 'n' : c;
+        }
+
+        token[n++] = c;
+    }
+
+    if(quoted)
+        token[n++] = '"';
+
+    arenaCommit(&editor->arena, n);
+    *out        = token;
+    *out_length = n;
+
+    return CE_INI_OK;
+}
+
+static int validSlice(INISlice slice, int char_class)
+{
+    for(int i = 0; i < slice.length; i++)
+    {
+        if(!isCharClass(slice.ptr[i], char_class))
+            return 0;
+    }
+    return 1;
+}
+
+static int editorSet(CE_INI_Editor *editor, const char *section, const char *name, const char *value)
+{
+    INISlice section_slice = makeSlice(section, section + strlen(section));
+    INISlice name_slice = makeSlice(name, name + strlen(name));
+    unsigned hash = hashPair(section_slice.ptr, section_slice.length, name_slice.ptr, name_slice.length);
+    CE_INI_EditorEntry *entry = editorFind(editor, section_slice, name_slice, hash);
+    CE_INI_EditorSection *target;
+    const char *token;
+    size_t token_length;
+
+    if(entry)
+        return editorFormatValue(editor, value, entry->quoted, &entry->replacement, &entry->replacement_length);
+
+    if(editorFormatValue(editor, value, 0, &token, &token_length) == CE_INI_ERROR)
+        return CE_INI_ERROR;
+
+    if(name_slice.length == 0 || !validSlice(name_slice, CE_INI_CHAR_NAME) || !validSlice(section_slice, CE_INI_CHAR_SECTION))
+        return err_i(CE_INI_ERROR_ARGUMENT, "invalid section or name", CE_INI_ERROR);
+
+    if(!(section_slice.ptr = editorCopy(editor, section_slice.ptr, section_slice.length)) ||
+       !(name_slice.ptr = editorCopy(editor, name_slice.ptr, name_slice.length)))
+    {
+        return err_i(CE_INI_ERROR_MEMORY, "out of memory", CE_INI_ERROR);
+    }
+
+    /* A new section gets a header entry and its own group at the end. */
+    if(!(target = editorFindSection(editor, section_slice)))
+    {
+        int group = ++editor->new_section_count;
+
+        if(editorGrowEntrySlots(editor) == CE_INI_ERROR ||
+           editorAddEntry(editor, &entry) == CE_INI_ERROR ||
+           editorUpdateSection(editor, section_slice, editor->length, group) == CE_INI_ERROR)
+        {
+            return CE_INI_ERROR;
+        }
+
+        entry->section     = section_slice;
+        entry->kind        = CE_INI_EDIT_HEADER;
+        entry->value_start = editor->length;
+        entry->group       = group;
+        target = editorFindSection(editor, section_slice);
+    }
+
+    if(editorGrowEntrySlots(editor) == CE_INI_ERROR || editorAddEntry(editor, &entry) == CE_INI_ERROR)
+        return CE_INI_ERROR;
+
+    entry->section     = section_slice;
+    entry->name        = name_slice;
+    entry->hash        = hash;
+    entry->kind        = CE_INI_EDIT_ADDED;
+    entry->value_start = target->insert;
+    entry->group       = target->group;
+    entry->replacement = token;
+    entry->replacement_length = token_length;
+    editorIndexEntry(editor);
+
+    return CE_INI_OK;
+}
+
+int CE_INI_EditorSet(CE_INI_Editor *editor, const char *section, const char *name, const char *value)
+{
+    return (editorSet(editor, section, name, value) == CE_INI_OK) ? CE_INI_OK : reportError(NULL, 0, 0, 0);
+}
+
+static int editorRemove(CE_INI_Editor *editor, const char *section, const char *name)
+{
+    INISlice section_slice = makeSlice(section, section + strlen(section));
+    INISlice name_slice = makeSlice(name, name + strlen(name));
+    unsigned hash = hashPair(section_slice.ptr, section_slice.length, name_slice.ptr, name_slice.length);
+    int found = 0;
+
+    if(editor->entry_table_size > 0)
+    {
+        for(size_t index = *editorEntrySlot(editor, section_slice, name_slice, hash); index != 0; index = editor->entries[index - 1].previous)
+        {
+            found |= !editor->entries[index - 1].removed;
+            editor->entries[index - 1].removed = 1;
+        }
+    }
+
+    return found ? CE_INI_OK : err_i(CE_INI_ERROR_ARGUMENT, "pair not found", CE_INI_ERROR);
+}
+
+int CE_INI_EditorRemove(CE_INI_Editor *editor, const char *section, const char *name)
+{
+    return (editorRemove(editor, section, name) == CE_INI_OK) ? CE_INI_OK : reportError(NULL, 0, 0, 0);
+}
+
+static int compareSplices(const void *a, const void *b)
+{
+    const INISplice *x = (const INISplice *)a;
+    const INISplice *y = (const INISplice *)b;
+
+    /* Insertions go in front of a removal starting at the same place. */
+    if(x->start != y->start)
+        return (x->start < y->start) ? -1 : 1;
+    if(x->end != y->end)
+        return (x->end < y->end) ? -1 : 1;
+    if(x->group != y->group)
+        return (x->group < y->group) ? -1 : 1;
+    return (x->sequence < y->sequence) ? -1 : (x->sequence > y->sequence);
+}
+
+static int editorWriteSplice(const CE_INI_Editor *editor, INIWriter *writer, const INISplice *splice, int *newline_pending)
+{
+    const CE_INI_EditorEntry *entry = &editor->entries[splice->sequence];
+
+    if(entry->kind == CE_INI_EDIT_ORIGINAL)
+        return (splice->length > 0) ? writerAppend(writer, splice->text, splice->length) : CE_INI_OK;
+
+    /* Insertions at the end need the last line to be terminated first. */
+    if(*newline_pending && splice->start == editor->length)
+    {
+        if(writerAppend(writer, "\n", 1) == CE_INI_ERROR)
+            return CE_INI_ERROR;
+        *newline_pending = 0;
+    }
+
+    if(entry->kind == CE_INI_EDIT_HEADER)
+    {
+        return (editor->length > 0 && writerAppend(writer, "\n", 1) == CE_INI_ERROR) ||
+               writerAppend(writer, "[", 1) == CE_INI_ERROR ||
+               writerAppend(writer, entry->section.ptr, entry->section.length) == CE_INI_ERROR ||
+               writerAppend(writer, "]\n", 2) == CE_INI_ERROR ? CE_INI_ERROR : CE_INI_OK;
+    }
+
+    return writerAppend(writer, entry->name.ptr, entry->name.length) == CE_INI_ERROR ||
+           writerAppend(writer, "=", 1) == CE_INI_ERROR ||
+           writerAppend(writer, splice->text, splice->length) == CE_INI_ERROR ||
+           writerAppend(writer, "\n", 1) == CE_INI_ERROR ? CE_INI_ERROR : CE_INI_OK;
+}
+
+static int editorSave(const CE_INI_Editor *editor, INIWriteFlushCallback flush, void *userdata)
+{
+    INISplice *splices;
+    size_t *live_counts;
+    size_t splice_count = 0;
+    size_t position = 0;
+    int newline_pending;
+    INIWriter writer;
+    int result = CE_INI_OK;
+
+    CE_INI_ASSERT(flush != NULL);
+
+    if(!(splices = (INISplice *)CE_INI_MALLOC((editor->entry_count + 1) * sizeof(INISplice) + (editor->new_section_count + 1) * sizeof(size_t))))
+        return err_i(CE_INI_ERROR_MEMORY, "out of memory", CE_INI_ERROR);
+
+    CE_INI_STAT_ENTER(scope);
+
+    /* Headers of new sections whose pairs were all removed are dropped. */
+    live_counts = (size_t *)(splices + editor->entry_count + 1);
+    memset(live_counts, 0, (editor->new_section_count + 1) * sizeof(size_t));
+
+    for(size_t i = 0; i < editor->entry_count; i++)
+    {
+        if(editor->entries[i].kind == CE_INI_EDIT_ADDED && !editor->entries[i].removed)
+            live_counts[editor->entries[i].group]++;
+    }
+
+    for(size_t i = 0; i < editor->entry_count; i++)
+    {
+        const CE_INI_EditorEntry *entry = &editor->entries[i];
+        INISplice *splice = &splices[splice_count];
+
+        if(entry->kind == CE_INI_EDIT_HEADER && live_counts[entry->group] == 0)
+            continue;
+
+        splice->group    = entry->group;
+        splice->sequence = i;
+        splice->text     = entry->replacement;
+        splice->length   = entry->replacement_length;
+
+        if(entry->kind == CE_INI_EDIT_ORIGINAL && entry->removed)
+        {
+            splice->start  = entry->remove_start;
+            splice->end    = entry->remove_end;
+            splice->length = 0;
+        }
+        else if(entry->kind == CE_INI_EDIT_ORIGINAL && entry->replacement)
+        {
+            splice->start = entry->value_start;
+            splice->end   = entry->value_end;
+        }
+        else if(entry->kind != CE_INI_EDIT_ORIGINAL && !entry->removed)
+        {
+            splice->start = entry->value_start;
+            splice->end   = entry->value_start;
+        }
+        else
+        {
+            continue;
+        }
+
+        splice_count++;
+    }
+
+    qsort(splices, splice_count, sizeof(INISplice), compareSplices);
+
+    memset(&writer, 0, sizeof(writer));
+    writer.capacity       = CE_INI_WRITE_BLOCK_SIZE;
+    writer.flush          = flush;
+    writer.flush_userdata = userdata;
+    newline_pending       = editor->length > 0 && editor->text[editor->length - 1] != '\n';
+
+    if(!(writer.buffer = (char *)CE_INI_MALLOC(writer.capacity)))
+    {
+        CE_INI_FREE(splices);
+        CE_INI_STAT_LEAVE(scope, write_ns);
+        return err_i(CE_INI_ERROR_MEMORY, "out of memory", CE_INI_ERROR);
+    }
+
+    for(size_t i = 0; i < splice_count && result == CE_INI_OK; i++)
+    {
+        const INISplice *splice = &splices[i];
+
+        /* A value inside a removed span has nothing left to replace. */
+        if(splice->start < position)
+            continue;
+
+        if(writerAppend(&writer, editor->text + position, splice->start - position) == CE_INI_ERROR ||
+           editorWriteSplice(editor, &writer, splice, &newline_pending) == CE_INI_ERROR)
+        {
+            result = CE_INI_ERROR;
+        }
+
+        position = splice->end;
+    }
+
+    if(result == CE_INI_OK && writerAppend(&writer, editor->text + position, editor->length - position) == CE_INI_ERROR)
+        result = CE_INI_ERROR;
+
+    if(result == CE_INI_OK)
+        result = writerFlush(&writer);
+
+    CE_INI_FREE(writer.buffer);
+    CE_INI_FREE(splices);
+
+    CE_INI_STAT_LEAVE(scope, write_ns);
+
+    return result;
+}
+
+int CE_INI_EditorSave(const CE_INI_Editor *editor, INIWriteFlushCallback flush, void *userdata)
+{
+    return (editorSave(editor, flush, userdata) == CE_INI_OK) ? CE_INI_OK : reportError(NULL, 0, 0, 0);
+}
+
+void CE_INI_EditorFree(CE_INI_Editor *editor)
+{
+    CE_INI_FREE(editor->entries);
+    CE_INI_FREE(editor->sections);
+    CE_INI_FREE(editor->entry_slots);
+    CE_INI_FREE(editor->section_slots);
+    CE_INI_ArenaFree(&editor->arena);
+    memset(editor, 0, sizeof(*editor));
+}
+
+/*----------------------------------------------------------------------------
+ * Reloadable Stores
+ *
+ * Epoch based reclamation. A reader stores the current epoch in its slot
+ * before loading the current snapshot, 0 marks a slot outside of acquire
+ * and release. A reload swaps the snapshot first and advances the epoch
+ * after, the old snapshot is retired with the new epoch: a reader that
+ * entered with it loaded the snapshot after the swap. Retired snapshots are
+ * freed once every busy slot holds at least their epoch. The sequentially
+ * consistent accesses order each reader's slot store before its snapshot
+ * load, and the swap before the reload's slot scan.
+ *---------------------------------------------------------------------------*/
+#ifdef CE_INI_STORE
+
+#define CE_INI_STORE_READERS 64
+#define CE_INI_CACHE_LINE    64
+
+/* Memory of posix_memalign goes back to free, so it is only taken with the
+   default allocator and where it is declared. */
+#if !defined(CE_INI_CUSTOM_ALLOCATOR) && ((defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200112L) || defined(__APPLE__))
+#define CE_INI_POSIX_MEMALIGN
+#endif
+
+struct CE_INI_StoreSnapshot
+{
+    CE_INI_Doc            doc;
+    CE_INI_StoreSnapshot *next;
+    unsigned long long    epoch;
+};
+
+/* A cache line per reader, readers on different cores do not share one. */
+struct CE_INI_StoreReader
+{
+    unsigned long long epoch;
+    int                used;
+    char               padding[CE_INI_CACHE_LINE - sizeof(unsigned long long) - sizeof(int)];
+};
+
+/* Allocates the reader slots on a cache line boundary, otherwise a block
+   a line larger is aligned by hand. */
+static int storeAllocReaders(CE_INI_Store *store)
+{
+    size_t size = (size_t)store->reader_count * sizeof(CE_INI_StoreReader);
+
+#ifdef CE_INI_POSIX_MEMALIGN
+    if(posix_memalign(&store->reader_block, CE_INI_CACHE_LINE, size) != 0)
+    {
+        store->reader_block = NULL;
+        return err_i(CE_INI_ERROR_MEMORY, "out of memory", CE_INI_ERROR);
+    }
+
+    store->readers = (CE_INI_StoreReader *)store->reader_block;
+#else
+    if(!(store->reader_block = CE_INI_MALLOC(size + CE_INI_CACHE_LINE - 1)))
+        return err_i(CE_INI_ERROR_MEMORY, "out of memory", CE_INI_ERROR);
+
+    store->readers = (CE_INI_StoreReader *)((char *)store->reader_block + (-(size_t)store->reader_block & (CE_INI_CACHE_LINE - 1)));
+#endif
+
+    memset(store->readers, 0, size);
+
+    return CE_INI_OK;
+}
+
+static void storeFreeReaders(CE_INI_Store *store)
+{
+#ifdef CE_INI_POSIX_MEMALIGN
+    free(store->reader_block);
+#else
+    CE_INI_FREE(store->reader_block);
+#endif
+}
+
+static CE_INI_StoreSnapshot* storeLoad(CE_INI_Store *store)
+{
+    CE_INI_StoreSnapshot *snapshot;
+    struct stat st;
+    INIFile file;
+    int result;
+
+    if(stat(store->path, &st) == 0)
+    {
+        store->mtime = (long long)st.st_mtime;
+        store->size  = (long long)st.st_size;
+        store->inode = (unsigned long long)st.st_ino;
+    }
+
+    if(openFile(&file, store->path) == CE_INI_ERROR)
+        return NULL;
+
+    if(!(snapshot = (CE_INI_StoreSnapshot *)CE_INI_MALLOC(sizeof(CE_INI_StoreSnapshot))))
+    {
+        closeFile(&file);
+        err(CE_INI_ERROR_MEMORY, "out of memory", NULL);
+        return NULL;
+    }
+
+    result = CE_INI_DocLoad(&snapshot->doc, file.data, file.length);
+    closeFile(&file);
+
+    if(result == CE_INI_ERROR)
+    {
+        CE_INI_FREE(snapshot);
+        return NULL;
+    }
+
+    snapshot->next  = NULL;
+    snapshot->epoch = 0;
+
+    return snapshot;
+}
+
+static void storeFree(CE_INI_StoreSnapshot *snapshot)
+{
+    CE_INI_DocFree(&snapshot->doc);
+    CE_INI_FREE(snapshot);
+}
+
+static void storeReclaim(CE_INI_Store *store)
+{
+    unsigned long long oldest = ULLONG_MAX;
+    CE_INI_StoreSnapshot **link = &store->retired;
+
+    if(!store->retired)
+        return;
+
+    for(int i = 0; i < store->reader_count; i++)
+    {
+        unsigned long long epoch = CE_INI_ATOMIC_LOAD(&store->readers[i].epoch);
+
+        if(epoch != 0 && epoch < oldest)
+            oldest = epoch;
+    }
+
+    while(*link)
+    {
+        CE_INI_StoreSnapshot *snapshot = *link;
+
+        if(snapshot->epoch <= oldest)
+        {
+            *link = snapshot->next;
+            storeFree(snapshot);
+        }
+        else
+        {
+            link = &snapshot->next;
+        }
+    }
+}
+
+#ifdef CE_INI_INOTIFY
+
+/* Watches the directory, editors often replace the file by renaming a new
+   one over it. */
+static int storeWatch(CE_INI_Store *store)
+{
+    size_t dir_length = store->name - store->path;
+    char *dir;
+
+    if((store->watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) < 0)
+        return err_i(CE_INI_ERROR_IO, "failed to watch file", CE_INI_ERROR);
+
+    if(!(dir = (char *)CE_INI_MALLOC(dir_length + 2)))
+        return err_i(CE_INI_ERROR_MEMORY, "out of memory", CE_INI_ERROR);
+
+    if(dir_length == 0)
+        dir[dir_length++] = '.';
+    else
+        memcpy(dir, store->path, dir_length);
+    dir[dir_length] = '\0';
+
+    if(inotify_add_watch(store->watch_fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        CE_INI_FREE(dir);
+        return err_i(CE_INI_ERROR_IO, "failed to watch file", CE_INI_ERROR);
+    }
+
+    CE_INI_FREE(dir);
+
+    return CE_INI_OK;
+}
+
+/* Waits for events and returns 1 if one is about the file. */
+static int storeChanged(CE_INI_Store *store, int timeout_ms)
+{
+    union
+    {
+        struct inotify_event event;
+        char                 bytes[4096];
+    } buffer;
+    struct pollfd fd;
+    ssize_t length;
+    int changed = 0;
+
+    fd.fd      = store->watch_fd;
+    fd.events  = POLLIN;
+    fd.revents = 0;
+
+    if(poll(&fd, 1, timeout_ms) < 0 && errno != EINTR)
+        return err_i(CE_INI_ERROR_IO, "failed to watch file", -1);
+
+    while((length = read(store->watch_fd, buffer.bytes, sizeof(buffer.bytes))) > 0)
+    {
+        for(ssize_t i = 0; i < length; )
+        {
+            const struct inotify_event *event = (const struct inotify_event *)(buffer.bytes + i);
+
+            if(event->len > 0 && strcmp(event->name, store->name) == 0)
+                changed = 1;
+
+            i += sizeof(struct inotify_event) + event->len;
+        }
+    }
+
+    return changed;
+}
+
+#else
+
+static int storeWatch(CE_INI_Store *store)
+{
+    (void)store;
+    return CE_INI_OK;
+}
+
+static int storeStatChanged(CE_INI_Store *store)
+{
+    struct stat st;
+
+    if(stat(store->path, &st) != 0)
+        return 0;
+
+    return (long long)st.st_mtime != store->mtime ||
+           (long long)st.st_size != store->size ||
+           (unsigned long long)st.st_ino != store->inode;
+}
+
+/* Checks, waits for timeout_ms and checks again. */
+static int storeChanged(CE_INI_Store *store, int timeout_ms)
+{
+    if(storeStatChanged(store))
+        return 1;
+
+    if(timeout_ms != 0)
+        poll(NULL, 0, timeout_ms);
+
+    return storeStatChanged(store);
+}
+
+#endif /* CE_INI_INOTIFY */
+
+int CE_INI_StoreOpen(CE_INI_Store *store, const char *path, int reader_count)
+{
+    size_t path_length;
+    const char *slash;
+
+    CE_INI_ASSERT(store != NULL);
+    CE_INI_ASSERT(path != NULL);
+
+    memset(store, 0, sizeof(*store));
+    store->watch_fd     = -1;
+    store->epoch        = 1;
+    store->reader_count = reader_count > 0 ? reader_count : CE_INI_STORE_READERS;
+
+    path_length = strlen(path);
+
+    if(!(store->path = (char *)CE_INI_MALLOC(path_length + 1)))
+        err(CE_INI_ERROR_MEMORY, "out of memory", NULL);
+
+    if(!store->path || storeAllocReaders(store) == CE_INI_ERROR)
+    {
+        CE_INI_StoreClose(store);
+        return reportError(NULL, 0, 0, 0);
+    }
+
+    memcpy(store->path, path, path_length + 1);
+
+    slash = strrchr(store->path, '/');
+    store->name = slash ? slash + 1 : store->path;
+
+    if(!(store->current = storeLoad(store)) || storeWatch(store) == CE_INI_ERROR)
+    {
+        CE_INI_StoreClose(store);
+        return reportError(NULL, 0, 0, 0);
+    }
+
+    return CE_INI_OK;
+}
+
+int CE_INI_StoreReload(CE_INI_Store *store)
+{
+    CE_INI_StoreSnapshot *snapshot, *old;
+
+    if(!(snapshot = storeLoad(store)))
+        return reportError(NULL, 0, 0, 0);
+
+    old = CE_INI_ATOMIC_EXCHANGE(&store->current, snapshot);
+    old->epoch = CE_INI_ATOMIC_ADD(&store->epoch, 1);
+    old->next = store->retired;
+    store->retired = old;
+
+    storeReclaim(store);
+
+    return CE_INI_OK;
+}
+
+int CE_INI_StorePoll(CE_INI_Store *store, int timeout_ms)
+{
+    int changed;
+
+    storeReclaim(store);
+
+    if((changed = storeChanged(store, timeout_ms)) < 0)
+        return reportError(NULL, 0, 0, 0);
+
+    return changed ? CE_INI_StoreReload(store) : CE_INI_OK;
+}
+
+void CE_INI_StoreClose(CE_INI_Store *store)
+{
+    while(store->retired)
+    {
+        CE_INI_StoreSnapshot *next = store->retired->next;
+        storeFree(store->retired);
+        store->retired = next;
+    }
+
+    if(store->current)
+        storeFree(store->current);
+
+    if(store->watch_fd >= 0)
+        close(store->watch_fd);
+
+    CE_INI_FREE(store->path);
+    storeFreeReaders(store);
+    memset(store, 0, sizeof(*store));
+    store->watch_fd = -1;
+}
+
+int CE_INI_StoreRegister(CE_INI_Store *store)
+{
+    for(int i = 0; i < store->reader_count; i++)
+    {
+        if(CE_INI_ATOMIC_LOAD(&store->readers[i].used) == 0 && CE_INI_ATOMIC_CLAIM(&store->readers[i].used) == 0)
+            return i;
+    }
+
+    err(CE_INI_ERROR_ARGUMENT, "no free reader slot", NULL);
+    reportError(NULL, 0, 0, 0);
+
+    return -1;
+}
+
+void CE_INI_StoreUnregister(CE_INI_Store *store, int reader)
+{
+    CE_INI_ASSERT(reader >= 0 && reader < store->reader_count);
+
+    CE_INI_ATOMIC_STORE(&store->readers[reader].epoch, 0);
+    CE_INI_ATOMIC_STORE(&store->readers[reader].used, 0);
+}
+
+const CE_INI_Doc* CE_INI_StoreAcquire(CE_INI_Store *store, int reader)
+{
+    CE_INI_StoreReader *slot = &store->readers[reader];
+
+    CE_INI_ATOMIC_STORE(&slot->epoch, CE_INI_ATOMIC_LOAD(&store->epoch));
+
+    return &CE_INI_ATOMIC_LOAD(&store->current)->doc;
+}
+
+void CE_INI_StoreRelease(CE_INI_Store *store, int reader)
+{
+    CE_INI_ATOMIC_RELEASE(&store->readers[reader].epoch, 0);
+}
+
+#endif /* CE_INI_STORE */
+
 #endif /* CE_INI_IMPLEMENTATION */
 
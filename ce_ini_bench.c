@@ -0,0 +1,364 @@
+/*
+  Benchmarks for ce_ini.h.
+
+  Build and run with:
+     make bench
+
+  which also runs ce_ini_bench_scalar, built with -DCE_INI_NO_SIMD to
+  measure the scalar scanners. The numbers of both builds can be compared
+  directly. Pass a number of seconds per benchmark as the first argument,
+  the default is 0.5.
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CE_INI_IMPLEMENTATION
+#include "ce_ini.h"
+
+
+/*----------------------------------------------------------------------------
+ * Corpus
+ *---------------------------------------------------------------------------*/
+typedef struct
+{
+    char   *text;
+    size_t  length;
+    size_t  capacity;
+    size_t  entries;
+} Corpus;
+
+static void corpusAppend(Corpus *corpus, const char *text)
+{
+    size_t length = strlen(text);
+
+    if(corpus->length + length + 1 > corpus->capacity)
+    {
+        corpus->capacity = (corpus->capacity + length + 1) * 2;
+        corpus->text     = (char*)realloc(corpus->text, corpus->capacity);
+        if(!corpus->text)
+        {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+
+    memcpy(corpus->text + corpus->length, text, length + 1);
+    corpus->length += length;
+}
+
+/* 20000 sections with 4 short options each. */
+static void smallSections(Corpus *corpus)
+{
+    char line[128];
+    int  i;
+
+    for(i = 0; i < 20000; ++i)
+    {
+        sprintf(line, "[section_%d]\n", i);
+        corpusAppend(corpus, line);
+        sprintf(line, "name = item%d\nport = %d\nenabled = true\npath = /var/lib/%d\n\n", i, 1000 + i % 5000, i);
+        corpusAppend(corpus, line);
+        corpus->entries += 4;
+    }
+}
+
+/* 4 sections with 25000 options each. */
+static void hugeSections(Corpus *corpus)
+{
+    char line[128];
+    int  i, j;
+
+    for(i = 0; i < 4; ++i)
+    {
+        sprintf(line, "[bulk_%d]\n", i);
+        corpusAppend(corpus, line);
+
+        for(j = 0; j < 25000; ++j)
+        {
+            sprintf(line, "key.%d.%d = value number %d of a rather large section\n", i, j, j);
+            corpusAppend(corpus, line);
+            corpus->entries++;
+        }
+    }
+}
+
+/* Mostly comments and blank lines, with an option every few lines. */
+static void commentHeavy(Corpus *corpus)
+{
+    char line[160];
+    int  i;
+
+    corpusAppend(corpus, "[documented]\n");
+
+    for(i = 0; i < 20000; ++i)
+    {
+        corpusAppend(corpus, "; This option controls something important, see the manual for the\n");
+        corpusAppend(corpus, "; details. Changing it requires a restart of the service.\n");
+        corpusAppend(corpus, ";\n\n");
+        sprintf(line, "option_%d = %d   ; trailing comment after the value\n\n", i, i);
+        corpusAppend(corpus, line);
+        corpus->entries++;
+    }
+}
+
+/* Quoted values close to CE_INI_MAX_VALUE_LENGTH with escape sequences. */
+static void quotedValues(Corpus *corpus)
+{
+    char line[160];
+    int  i;
+
+    corpusAppend(corpus, "[strings]\n");
+
+    for(i = 0; i < 50000; ++i)
+    {
+        sprintf(line, "text_%d = \"C:\\\\Program Files\\\\app\\t\\\"quoted\\\" with escapes %06d\"\n", i, i);
+        corpusAppend(corpus, line);
+        corpus->entries++;
+    }
+}
+
+
+/*----------------------------------------------------------------------------
+ * Timing
+ *---------------------------------------------------------------------------*/
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void report(const char *name, size_t bytes, size_t entries, long iterations, double seconds)
+{
+    double total_bytes   = (double)bytes   * (double)iterations;
+    double total_entries = (double)entries * (double)iterations;
+
+    printf("%-28s %10.1f MB/s %12.0f entries/s %8.1f ns/entry\n",
+           name,
+           total_bytes / seconds / 1e6,
+           total_entries / seconds,
+           seconds * 1e9 / total_entries);
+}
+
+
+/*----------------------------------------------------------------------------
+ * Reading
+ *---------------------------------------------------------------------------*/
+static void countEntry(const char *section, const char *name, const char *value, void *userdata)
+{
+    (void)section; (void)name; (void)value;
+    ++*(size_t*)userdata;
+}
+
+static void countSlice(const char *section, int section_length, const char *name, int name_length, const char *value, int value_length, void *userdata)
+{
+    (void)section; (void)section_length; (void)name; (void)name_length; (void)value; (void)value_length;
+    ++*(size_t*)userdata;
+}
+
+static void benchRead(const char *name, const Corpus *corpus, double duration)
+{
+    char   label[64];
+    long   iterations = 0;
+    size_t count;
+    double start, seconds;
+
+    count = 0;
+    if(CE_INI_ReadN(corpus->text, corpus->length, countEntry, &count) != CE_INI_OK || count != corpus->entries)
+    {
+        fprintf(stderr, "%s: read %lu of %lu entries\n", name, (unsigned long)count, (unsigned long)corpus->entries);
+        exit(1);
+    }
+
+    start = now();
+    do
+    {
+        CE_INI_ReadN(corpus->text, corpus->length, countEntry, &count);
+        ++iterations;
+        seconds = now() - start;
+    } while(seconds < duration);
+
+    sprintf(label, "read   %s", name);
+    report(label, corpus->length, corpus->entries, iterations, seconds);
+
+    iterations = 0;
+    start      = now();
+    do
+    {
+        CE_INI_ReadSlices(corpus->text, corpus->length, countSlice, &count);
+        ++iterations;
+        seconds = now() - start;
+    } while(seconds < duration);
+
+    sprintf(label, "slices %s", name);
+    report(label, corpus->length, corpus->entries, iterations, seconds);
+}
+
+
+/* 100000 integers and doubles, read with the standard library and with the
+   conversions of ce_ini.h. */
+static void numeric(Corpus *corpus)
+{
+    char line[128];
+    int  i;
+
+    corpusAppend(corpus, "[numbers]\n");
+
+    for(i = 0; i < 50000; ++i)
+    {
+        sprintf(line, "count_%d = %d\nratio_%d = %d.%03d\n", i, (i * 7919) % 100000000, i, i % 1000, (i * 31) % 1000);
+        corpusAppend(corpus, line);
+        corpus->entries += 2;
+    }
+}
+
+static void convertStdlib(const char *section, const char *name, const char *value, void *userdata)
+{
+    (void)section;
+    *(double*)userdata += (name[0] == 'c') ? (double)strtol(value, NULL, 10) : strtod(value, NULL);
+}
+
+static void convertSlice(const char *section, int section_length, const char *name, int name_length, const char *value, int value_length, void *userdata)
+{
+    long long n;
+    double    d;
+
+    (void)section; (void)section_length; (void)name_length;
+
+    if(name[0] == 'c')
+        *(double*)userdata += (CE_INI_ToLong(value, value_length, &n) == CE_INI_OK) ? (double)n : 0.0;
+    else
+        *(double*)userdata += (CE_INI_ToDouble(value, value_length, &d) == CE_INI_OK) ? d : 0.0;
+}
+
+static void benchConvert(const Corpus *corpus, double duration)
+{
+    long   iterations = 0;
+    double sum = 0.0;
+    double start, seconds;
+
+    start = now();
+    do
+    {
+        CE_INI_ReadN(corpus->text, corpus->length, convertStdlib, &sum);
+        ++iterations;
+        seconds = now() - start;
+    } while(seconds < duration);
+
+    report("strtol/strtod numeric", corpus->length, corpus->entries, iterations, seconds);
+
+    iterations = 0;
+    start      = now();
+    do
+    {
+        CE_INI_ReadSlices(corpus->text, corpus->length, convertSlice, &sum);
+        ++iterations;
+        seconds = now() - start;
+    } while(seconds < duration);
+
+    report("CE_INI_To* numeric", corpus->length, corpus->entries, iterations, seconds);
+}
+
+
+/*----------------------------------------------------------------------------
+ * Writing
+ *---------------------------------------------------------------------------*/
+typedef struct
+{
+    int sections;
+    int quoted;
+} WriteShape;
+
+static void writeOption(int index, char section[CE_INI_MAX_SECTION_LENGTH], char name[CE_INI_MAX_NAME_LENGTH], char value[CE_INI_MAX_VALUE_LENGTH], void *userdata)
+{
+    const WriteShape *shape = (const WriteShape*)userdata;
+
+    sprintf(section, "section_%d", index % shape->sections);
+    sprintf(name, "option_%d", index);
+
+    if(shape->quoted)
+        sprintf(value, "C:\\Program Files\\app\t\"quoted\" %d", index);
+    else
+        sprintf(value, "%d", index * 7);
+}
+
+static void benchWrite(const char *name, int count, int sections, int quoted, double duration)
+{
+    WriteShape shape;
+    char       label[64];
+    char      *buffer;
+    int        length = 0;
+    long       iterations = 0;
+    double     start, seconds;
+
+    shape.sections = sections;
+    shape.quoted   = quoted;
+
+    if(CE_INI_WriteN(NULL, 0, &length, count, writeOption, &shape) != CE_INI_OK)
+    {
+        fprintf(stderr, "%s: size query failed\n", name);
+        exit(1);
+    }
+
+    buffer = (char*)malloc((size_t)length + 1);
+    if(!buffer)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+
+    start = now();
+    do
+    {
+        CE_INI_WriteN(buffer, length + 1, &length, count, writeOption, &shape);
+        ++iterations;
+        seconds = now() - start;
+    } while(seconds < duration);
+
+    sprintf(label, "write  %s", name);
+    report(label, (size_t)length, (size_t)count, iterations, seconds);
+
+    free(buffer);
+}
+
+
+int main(int argc, char **argv)
+{
+    Corpus corpus;
+    double duration = (argc > 1) ? atof(argv[1]) : 0.5;
+
+    memset(&corpus, 0, sizeof(corpus));
+    smallSections(&corpus);
+    benchRead("small sections", &corpus, duration);
+
+    corpus.length = corpus.entries = 0;
+    hugeSections(&corpus);
+    benchRead("huge sections", &corpus, duration);
+
+    corpus.length = corpus.entries = 0;
+    commentHeavy(&corpus);
+    benchRead("comment heavy", &corpus, duration);
+
+    corpus.length = corpus.entries = 0;
+    quotedValues(&corpus);
+    benchRead("quoted escapes", &corpus, duration);
+
+    corpus.length = corpus.entries = 0;
+    numeric(&corpus);
+    benchRead("numeric", &corpus, duration);
+    benchConvert(&corpus, duration);
+
+    free(corpus.text);
+
+    benchWrite("256 options", 256, 16, 0, duration);
+    benchWrite("256 options quoted", 256, 16, 1, duration);
+    benchWrite("100k options", 100000, 1000, 0, duration);
+
+    return 0;
+}
@@ -0,0 +1,1511 @@
+/*
+  Regression tests for ce_ini.h.
+
+  Build and run with:
+     make test
+
+  which builds it as C, as C with -DCE_INI_NO_SIMD and with -DCE_INI_STATS,
+  and as C++20, and runs all of them.
+
+  Prints every failed check and exits with 1 if there was one.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <locale.h>
+
+#define CE_INI_IMPLEMENTATION
+#include "ce_ini.h"
+
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { if(!(condition)) { printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); ++failures; } } while(0)
+
+
+/*----------------------------------------------------------------------------
+ * Output
+ *---------------------------------------------------------------------------*/
+typedef struct
+{
+    char   text[4096];
+    size_t length;
+} Output;
+
+static void clearOutput(Output *output)
+{
+    output->length  = 0;
+    output->text[0] = '\0';
+}
+
+static int appendText(Output *output, const char *data, size_t length)
+{
+    if(output->length + length >= sizeof(output->text))
+        return CE_INI_ERROR;
+
+    memcpy(output->text + output->length, data, length);
+    output->length += length;
+    output->text[output->length] = '\0';
+
+    return CE_INI_OK;
+}
+
+/* Pairs as "section.name=value|". */
+static void collectSlice(const char *section, int section_length, const char *name, int name_length, const char *value, int value_length, void *userdata)
+{
+    Output *output = (Output*)userdata;
+
+    appendText(output, section, section_length);
+    appendText(output, ".", 1);
+    appendText(output, name, name_length);
+    appendText(output, "=", 1);
+    appendText(output, value, value_length);
+    appendText(output, "|", 1);
+}
+
+static void collectPair(const char *section, const char *name, const char *value, void *userdata)
+{
+    collectSlice(section, (int)strlen(section), name, (int)strlen(name), value, (int)strlen(value), userdata);
+}
+
+static int appendOutput(const char *data, size_t length, void *userdata)
+{
+    return appendText((Output*)userdata, data, length);
+}
+
+static const char* saveEditor(const CE_INI_Editor *editor, Output *output)
+{
+    clearOutput(output);
+
+    return (CE_INI_EditorSave(editor, appendOutput, output) == CE_INI_OK) ? output->text : NULL;
+}
+
+/* Order dependent hash and count of the pairs, for texts too large to
+   collect. */
+typedef struct
+{
+    unsigned hash;
+    int      count;
+} Digest;
+
+static void digestBytes(Digest *digest, const char *str, int length)
+{
+    for(int i = 0; i < length; i++)
+        digest->hash = (digest->hash ^ (unsigned char)str[i]) * 16777619u;
+    digest->hash = (digest->hash ^ 0x100u) * 16777619u;
+}
+
+static void digestSlice(const char *section, int section_length, const char *name, int name_length, const char *value, int value_length, void *userdata)
+{
+    Digest *digest = (Digest*)userdata;
+
+    digestBytes(digest, section, section_length);
+    digestBytes(digest, name, name_length);
+    digestBytes(digest, value, value_length);
+    digest->count++;
+}
+
+static void initDigest(Digest *digest)
+{
+    digest->hash  = 2166136261u;
+    digest->count = 0;
+}
+
+static void digestPair(const char *section, const char *name, const char *value, void *userdata)
+{
+    digestSlice(section, (int)strlen(section), name, (int)strlen(name), value, (int)strlen(value), userdata);
+}
+
+static int errorCount = 0;
+static int errorCode  = 0;
+
+static void countError(const CE_INI_Error *error, void *userdata)
+{
+    (void)userdata;
+    errorCount++;
+    errorCode = error->code;
+}
+
+
+/*----------------------------------------------------------------------------
+ * Reading
+ *---------------------------------------------------------------------------*/
+static void testReadNUnterminated(void)
+{
+    /* Exactly the text, without a '\0' behind it. */
+    const char *source = "[a]\nx = 1\ny = \"two\"";
+    size_t      length = strlen(source);
+    char       *text   = (char*)malloc(length);
+    Output      output;
+
+    memcpy(text, source, length);
+
+    clearOutput(&output);
+    CHECK(CE_INI_ReadN(text, length, collectPair, &output) == CE_INI_OK);
+    CHECK(strcmp(output.text, "a.x=1|a.y=two|") == 0);
+
+    /* Only the pairs inside length are read. */
+    clearOutput(&output);
+    CHECK(CE_INI_ReadN(text, strlen("[a]\nx = 1\n"), collectPair, &output) == CE_INI_OK);
+    CHECK(strcmp(output.text, "a.x=1|") == 0);
+
+    clearOutput(&output);
+    CHECK(CE_INI_ReadN(text, strlen("[a]\nx = 1"), collectPair, &output) == CE_INI_OK);
+    CHECK(strcmp(output.text, "a.x=1|") == 0);
+
+    /* A header cut off by length is not closed. */
+    clearOutput(&output);
+    CHECK(CE_INI_ReadN(text, 2, collectPair, &output) == CE_INI_ERROR);
+    CHECK(output.length == 0);
+
+    clearOutput(&output);
+    CHECK(CE_INI_ReadN(text, 0, collectPair, &output) == CE_INI_OK);
+    CHECK(output.length == 0);
+
+    free(text);
+}
+
+static void testReadNLimits(void)
+{
+    Output output;
+
+    clearOutput(&output);
+    /* length decides where the text ends, not a '\0'. */
+    clearOutput(&output);
+    CHECK(CE_INI_ReadN("x=1\n\0y=2\n", 10, collectPair, &output) == CE_INI_OK);
+    CHECK(strcmp(output.text, ".x=1|.y=2|") == 0);
+
+    /* The longest value that fits, and one byte more. */
+    CHECK(CE_INI_ReadN("x=012345678901234567890123456789012345678901234567890123456789012\n", 66, collectPair, &output) == CE_INI_OK);
+    CHECK(CE_INI_ReadN("x=0123456789012345678901234567890123456789012345678901234567890123\n", 67, collectPair, &output) == CE_INI_ERROR);
+}
+
+static int sliceInside = 1;
+
+static void checkSlice(const char *section, int section_length, const char *name, int name_length, const char *value, int value_length, void *userdata)
+{
+    const char *text = (const char*)userdata;
+    const char *end  = text + strlen(text);
+
+    (void)section_length;
+
+    /* Unquoted slices point into the text. */
+    sliceInside &= (section >= text && section <= end);
+    sliceInside &= (name >= text && name + name_length <= end);
+    sliceInside &= (value >= text && value + value_length <= end);
+}
+
+static void testReadSlices(void)
+{
+    const char *text = "; comment\n[first]\nname = value with spaces   \n[second]\nempty =\nquoted = \" padded \"\n";
+    Output      output;
+
+    clearOutput(&output);
+    CHECK(CE_INI_ReadSlices(text, strlen(text), collectSlice, &output) == CE_INI_OK);
+    CHECK(strcmp(output.text, "first.name=value with spaces|second.empty=|second.quoted= padded |") == 0);
+
+    CHECK(CE_INI_ReadSlices(text, strlen(text), checkSlice, (void*)text) == CE_INI_OK);
+    CHECK(sliceInside);
+
+    /* The slices are bounded by length, not by a '\0'. */
+    clearOutput(&output);
+    CHECK(CE_INI_ReadSlices("[s]\nk=abcdef", 10, collectSlice, &output) == CE_INI_OK);
+    CHECK(strcmp(output.text, "s.k=abcd|") == 0);
+}
+
+static void testReadSectionTooLong(void)
+{
+    const char *text = "[abcdefghijabcdefghijabcdefghijabcdefghij]\n";
+    Output      output;
+
+    clearOutput(&output);
+    CHECK(CE_INI_ReadN(text, strlen(text), collectPair, &output) == CE_INI_ERROR);
+    CHECK(CE_INI_ReadSlices(text, strlen(text), collectSlice, &output) == CE_INI_OK);
+}
+
+/* Names, sections and values of every length up to the limits, so the
+   scanners end at every position of a vector block. */
+static void testScannerLengths(void)
+{
+    char   text[256];
+    char   expected[256];
+    Output output;
+
+    for(int length = 1; length < CE_INI_MAX_VALUE_LENGTH; length++)
+    {
+        char value[CE_INI_MAX_VALUE_LENGTH];
+        char name[CE_INI_MAX_NAME_LENGTH];
+        char section[CE_INI_MAX_SECTION_LENGTH];
+        int  name_length    = length % (CE_INI_MAX_NAME_LENGTH - 1) + 1;
+        int  section_length = length % (CE_INI_MAX_SECTION_LENGTH - 1) + 1;
+
+        for(int i = 0; i < length; i++)
+            value[i] = (char)('a' + i % 26);
+        value[length] = '\0';
+
+        for(int i = 0; i < name_length; i++)
+            name[i] = (char)('A' + i % 26);
+        name[name_length] = '\0';
+
+        for(int i = 0; i < section_length; i++)
+            section[i] = (char)('0' + i % 10);
+        section[section_length] = '\0';
+
+        sprintf(text, "[%s]\n%s = %s\n", section, name, value);
+        sprintf(expected, "%s.%s=%s|", section, name, value);
+
+        clearOutput(&output);
+        CHECK(CE_INI_ReadSlices(text, strlen(text), collectSlice, &output) == CE_INI_OK);
+        CHECK(strcmp(output.text, expected) == 0);
+
+        /* A control character anywhere after the first byte of the value
+           is found (in front of it, it is whitespace). */
+        for(int i = 1; i < length; i++)
+        {
+            sprintf(text, "[s]\nk = %s\n", value);
+            text[8 + i] = '\x01';
+            CHECK(CE_INI_ReadSlices(text, strlen(text), collectSlice, &output) == CE_INI_ERROR);
+        }
+    }
+}
+
+static int isNameByte(int c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '.' || c == '-' || c == '_';
+}
+
+static void testCharacterClasses(void)
+{
+    Output output;
+
+    /* "a?b=1": accepted exactly when ? is a name character, or '=' which
+       starts the value early. */
+    for(int c = 1; c < 256; c++)
+    {
+        char text[8] = { 'a', (char)c, 'b', '=', '1', '\n', '\0' };
+        int  accepted;
+
+        clearOutput(&output);
+        accepted = (CE_INI_ReadSlices(text, 6, collectSlice, &output) == CE_INI_OK);
+        CHECK(accepted == (isNameByte(c) || c == '='));
+    }
+
+    /* Bytes above 0x7F are never part of a name or value. */
+    CHECK(CE_INI_ReadSlices("k=caf\xC3\xA9\n", 8, collectSlice, &output) == CE_INI_ERROR);
+    CHECK(CE_INI_ReadSlices("[\xC3\xA9]\n", 5, collectSlice, &output) == CE_INI_ERROR);
+}
+
+/* Every chunk size from 1 byte to the whole text gives the pairs of one
+   CE_INI_ReadSlices. */
+static void testFeedChunks(void)
+{
+    const char *text = "; header\n[alpha]\nx = 1\ny = \"a\\tb\" ; comment\r\n\n[beta gamma]\nlong.name-1 = some longer value\nz =";
+    size_t      length = strlen(text);
+    Output      expected;
+    Output      output;
+
+    clearOutput(&expected);
+    CHECK(CE_INI_ReadSlices(text, length, collectSlice, &expected) == CE_INI_OK);
+
+    for(size_t chunk = 1; chunk <= length; chunk++)
+    {
+        CE_INI_Parser parser;
+        int result = CE_INI_OK;
+
+        clearOutput(&output);
+        CE_INI_ParserInit(&parser, collectSlice, &output);
+
+        for(size_t offset = 0; offset < length && result == CE_INI_OK; offset += chunk)
+            result = CE_INI_Feed(&parser, text + offset, (length - offset < chunk) ? length - offset : chunk);
+
+        CHECK(result == CE_INI_OK);
+        CHECK(CE_INI_Finish(&parser) == CE_INI_OK);
+        CHECK(strcmp(output.text, expected.text) == 0);
+    }
+}
+
+static void testFeedError(void)
+{
+    CE_INI_Parser parser;
+    Output        output;
+
+    clearOutput(&output);
+    CE_INI_ParserInit(&parser, collectSlice, &output);
+    CHECK(CE_INI_Feed(&parser, "[a]\nx = 1\ny", 11) == CE_INI_OK);
+    CHECK(CE_INI_Feed(&parser, " 2\nz = 3\n", 9) == CE_INI_ERROR);
+    CHECK(CE_INI_Finish(&parser) == CE_INI_ERROR);
+    CHECK(strcmp(output.text, "a.x=1|") == 0);
+}
+
+static int writeTextFile(const char *path, const char *text)
+{
+    FILE *file = fopen(path, "wb");
+
+    if(!file)
+        return 0;
+
+    fputs(text, file);
+    fclose(file);
+
+    return 1;
+}
+
+static void testReadFile(void)
+{
+    const char *path = "ce_ini_test_read.ini";
+    Output      output;
+
+    CHECK(writeTextFile(path, "[a]\nx = 1\n[b]\ny = \"2\"\n"));
+
+    clearOutput(&output);
+    CHECK(CE_INI_ReadFile(path, collectPair, &output) == CE_INI_OK);
+    CHECK(strcmp(output.text, "a.x=1|b.y=2|") == 0);
+
+    /* An empty file has no pairs. */
+    CHECK(writeTextFile(path, ""));
+    clearOutput(&output);
+    CHECK(CE_INI_ReadFile(path, collectPair, &output) == CE_INI_OK);
+    CHECK(output.length == 0);
+
+    remove(path);
+    CHECK(CE_INI_ReadFile(path, collectPair, &output) == CE_INI_ERROR);
+}
+
+/* section_count sections of 4 pairs, enough of them give every thread of
+   CE_INI_ReadParallel a piece. */
+static char* makeSections(int section_count, size_t *length)
+{
+    size_t capacity = (size_t)section_count * 200 + 1;
+    char  *text     = (char*)malloc(capacity);
+    size_t n        = 0;
+
+    for(int s = 0; s < section_count; s++)
+    {
+        n += sprintf(text + n, "[section%d]\n; comment %d\n", s, s);
+
+        for(int k = 0; k < 4; k++)
+            n += sprintf(text + n, "key%d = \"value\\t%d.%d\"\n", k, s, k);
+    }
+
+    *length = n;
+    return text;
+}
+
+static void testReadParallelOrder(void)
+{
+    size_t length;
+    char  *text = makeSections(20000, &length);
+    Digest expected;
+    Digest digest;
+
+    CHECK(length > 8 * CE_INI_MIN_PARALLEL_SIZE);
+
+    initDigest(&expected);
+    CHECK(CE_INI_ReadSlices(text, length, digestSlice, &expected) == CE_INI_OK);
+    CHECK(expected.count == 80000);
+
+    for(int threads = 1; threads <= 8; threads *= 2)
+    {
+        initDigest(&digest);
+        CHECK(CE_INI_ReadParallel(text, length, threads, digestSlice, &digest) == CE_INI_OK);
+        CHECK(digest.count == expected.count && digest.hash == expected.hash);
+    }
+
+    /* An error in a later piece stops the pairs exactly where a sequential
+       read stops. */
+    memcpy(strstr(text, "[section15000]") + 14, "\nbroken", 7);
+
+    initDigest(&expected);
+    CHECK(CE_INI_ReadSlices(text, length, digestSlice, &expected) == CE_INI_ERROR);
+
+    initDigest(&digest);
+    CHECK(CE_INI_ReadParallel(text, length, 8, digestSlice, &digest) == CE_INI_ERROR);
+    CHECK(digest.count == expected.count && digest.hash == expected.hash);
+
+    free(text);
+}
+
+static void testDocLookup(void)
+{
+    const char *text = "top = 0\n[a]\nx = 1\ny = \"q\\tq\"\n[b]\nx = 2\n[a]\nx = 3\n";
+    CE_INI_Doc  doc;
+    const char *value;
+
+    CHECK(CE_INI_DocLoad(&doc, text, strlen(text)) == CE_INI_OK);
+
+    CHECK((value = CE_INI_Get(&doc, "", "top")) && strcmp(value, "0") == 0);
+    CHECK((value = CE_INI_Get(&doc, "a", "x")) && strcmp(value, "3") == 0);
+    CHECK((value = CE_INI_Get(&doc, "a", "y")) && strcmp(value, "q\tq") == 0);
+    CHECK((value = CE_INI_Get(&doc, "b", "x")) && strcmp(value, "2") == 0);
+    CHECK(CE_INI_Get(&doc, "b", "y") == NULL);
+    CHECK(CE_INI_Get(&doc, "c", "x") == NULL);
+    CHECK(CE_INI_Get(&doc, "a", "") == NULL);
+
+    CE_INI_DocFree(&doc);
+
+    CHECK(CE_INI_DocLoad(&doc, "[a\nx = 1\n", 9) == CE_INI_ERROR);
+}
+
+static void testDocManyPairs(void)
+{
+    size_t      length;
+    char       *text = makeSections(2000, &length);
+    CE_INI_Doc  doc;
+    const char *value;
+    char        section[32];
+
+    CHECK(CE_INI_DocLoad(&doc, text, length) == CE_INI_OK);
+
+    for(int s = 0; s < 2000; s += 7)
+    {
+        sprintf(section, "section%d", s);
+        value = CE_INI_Get(&doc, section, "key3");
+        CHECK(value && strncmp(value, "value\t", 6) == 0 && atoi(value + 6) == s);
+    }
+
+    CE_INI_DocFree(&doc);
+    free(text);
+}
+
+typedef struct
+{
+    const char *values[4];
+    int         lengths[4];
+    int         count;
+} KeptValues;
+
+static void keepValue(const char *section, int section_length, const char *name, int name_length, const char *value, int value_length, void *userdata)
+{
+    KeptValues *kept = (KeptValues*)userdata;
+
+    (void)section; (void)section_length; (void)name; (void)name_length;
+
+    if(kept->count < 4)
+    {
+        kept->values[kept->count]  = value;
+        kept->lengths[kept->count] = value_length;
+        kept->count++;
+    }
+}
+
+static void testReadArena(void)
+{
+    char         text[1024];
+    char         value[300];
+    char         section[100];
+    CE_INI_Arena arena;
+    KeptValues   kept;
+
+    memset(value, 'v', sizeof(value) - 1);
+    value[sizeof(value) - 1] = '\0';
+    memset(section, 's', sizeof(section) - 1);
+    section[sizeof(section) - 1] = '\0';
+
+    /* Far beyond the fixed limits, escaped values are decoded into the
+       arena and outlive the callback. */
+    sprintf(text, "[%s]\nplain = %s\nquoted = \"a\\tb\\\"c\"\nx = \"e\\n\"\n", section, value);
+
+    memset(&kept, 0, sizeof(kept));
+    CE_INI_ArenaInit(&arena, 64);
+    CHECK(CE_INI_ReadArena(text, strlen(text), &arena, keepValue, &kept) == CE_INI_OK);
+    CHECK(kept.count == 3);
+    CHECK(kept.lengths[0] == 299 && strncmp(kept.values[0], value, 299) == 0);
+    CHECK(kept.lengths[1] == 5 && memcmp(kept.values[1], "a\tb\"c", 5) == 0);
+    CHECK(kept.lengths[2] == 2 && memcmp(kept.values[2], "e\n", 2) == 0);
+    CE_INI_ArenaFree(&arena);
+
+    CE_INI_ArenaInit(&arena, 0);
+    CHECK(CE_INI_ReadArena("k = \"\\q\"\n", 9, &arena, keepValue, &kept) == CE_INI_ERROR);
+    CE_INI_ArenaFree(&arena);
+}
+
+static void testArenaAlloc(void)
+{
+    CE_INI_Arena arena;
+    char        *small;
+    char        *large;
+
+    CE_INI_ArenaInit(&arena, 128);
+
+    small = (char*)CE_INI_ArenaAlloc(&arena, 100);
+    large = (char*)CE_INI_ArenaAlloc(&arena, 1000);
+    CHECK(small && large);
+
+    if(small && large)
+    {
+        memset(small, 1, 100);
+        memset(large, 2, 1000);
+        CHECK(small[99] == 1 && large[0] == 2);
+    }
+
+    CE_INI_ArenaFree(&arena);
+}
+
+static void testArenaAllocAfterRead(void)
+{
+    CE_INI_Arena arena;
+    KeptValues   kept;
+    double      *number;
+
+    /* The decoded value leaves the arena at an odd offset. */
+    memset(&kept, 0, sizeof(kept));
+    CE_INI_ArenaInit(&arena, 0);
+    CHECK(CE_INI_ReadArena("k = \"a\\tbc\"\n", 12, &arena, keepValue, &kept) == CE_INI_OK);
+
+    number = (double*)CE_INI_ArenaAlloc(&arena, sizeof(double));
+    CHECK(number != NULL && (size_t)number % sizeof(double) == 0);
+
+    if(number)
+        *number = 1.5;
+
+    CHECK(kept.count == 1 && memcmp(kept.values[0], "a\tbc", 4) == 0);
+    CE_INI_ArenaFree(&arena);
+}
+
+
+/*----------------------------------------------------------------------------
+ * Writing
+ *---------------------------------------------------------------------------*/
+/* Option i is "key<i> = value <i>" in section "s<i % sections>". */
+typedef struct
+{
+    int sections;
+} Options;
+
+static void writeOption(int index, char section[CE_INI_MAX_SECTION_LENGTH], char name[CE_INI_MAX_NAME_LENGTH], char value[CE_INI_MAX_VALUE_LENGTH], void *userdata)
+{
+    const Options *options = (const Options*)userdata;
+
+    sprintf(section, "s%d", index % options->sections);
+    sprintf(name, "key%d", index);
+    sprintf(value, "value %d", index);
+}
+
+static void digestOptions(Digest *digest, int option_count, const Options *options)
+{
+    char section[CE_INI_MAX_SECTION_LENGTH];
+    char name[CE_INI_MAX_NAME_LENGTH];
+    char value[CE_INI_MAX_VALUE_LENGTH];
+
+    /* Grouped by section in the order the sections first appear. */
+    initDigest(digest);
+
+    for(int s = 0; s < options->sections; s++)
+    {
+        for(int i = s; i < option_count; i += options->sections)
+        {
+            writeOption(i, section, name, value, (void*)options);
+            digestPair(section, name, value, digest);
+        }
+    }
+}
+
+static int countOccurrences(const char *text, const char *pattern)
+{
+    int count = 0;
+
+    for(const char *at = strstr(text, pattern); at; at = strstr(at + 1, pattern))
+        count++;
+
+    return count;
+}
+
+static void testWriteGroups(void)
+{
+    Options options = { 3 };
+    char    buffer[1024];
+    Digest  expected;
+    Digest  digest;
+
+    CHECK(CE_INI_Write(buffer, sizeof(buffer), 10, writeOption, &options) == CE_INI_OK);
+    CHECK(countOccurrences(buffer, "[s0]") == 1);
+    CHECK(countOccurrences(buffer, "[s1]") == 1);
+    CHECK(countOccurrences(buffer, "[s2]") == 1);
+
+    digestOptions(&expected, 10, &options);
+    initDigest(&digest);
+    CHECK(CE_INI_ReadN(buffer, strlen(buffer), digestPair, &digest) == CE_INI_OK);
+    CHECK(digest.count == expected.count && digest.hash == expected.hash);
+
+    CHECK(CE_INI_Write(buffer, 20, 10, writeOption, &options) == CE_INI_ERROR);
+}
+
+static void testWriteManyOptions(void)
+{
+    static char buffer[1 << 16];
+    Options     options = { 7 };
+    Digest      expected;
+    Digest      digest;
+
+    /* Well past the old limit of 256 options. */
+    CHECK(CE_INI_Write(buffer, sizeof(buffer), 1000, writeOption, &options) == CE_INI_OK);
+
+    digestOptions(&expected, 1000, &options);
+    initDigest(&digest);
+    CHECK(CE_INI_ReadN(buffer, strlen(buffer), digestPair, &digest) == CE_INI_OK);
+    CHECK(digest.count == 1000 && digest.hash == expected.hash);
+}
+
+static void testWriteNLength(void)
+{
+    char    buffer[1024];
+    Options options = { 2 };
+    int     length  = -1;
+
+    CHECK(CE_INI_WriteN(buffer, sizeof(buffer), &length, 9, writeOption, &options) == CE_INI_OK);
+    CHECK(length == (int)strlen(buffer));
+
+    /* Too small by one byte for the '\0'. */
+    CHECK(CE_INI_WriteN(buffer, length, NULL, 9, writeOption, &options) == CE_INI_ERROR);
+    CHECK(CE_INI_WriteN(buffer, length + 1, NULL, 9, writeOption, &options) == CE_INI_OK);
+}
+
+static void testWriteSizeQuery(void)
+{
+    static char buffer[1 << 16];
+    Options     options = { 5 };
+    int         size    = -1;
+    int         length  = -1;
+
+    CHECK(CE_INI_WriteN(NULL, 0, &size, 500, writeOption, &options) == CE_INI_OK);
+    CHECK(CE_INI_WriteN(buffer, size + 1, &length, 500, writeOption, &options) == CE_INI_OK);
+    CHECK(size == length && length == (int)strlen(buffer));
+}
+
+typedef struct
+{
+    char  *text;
+    size_t length;
+    size_t capacity;
+    int    flushes;
+} Sink;
+
+static int appendSink(const char *data, size_t length, void *userdata)
+{
+    Sink *sink = (Sink*)userdata;
+
+    if(sink->length + length > sink->capacity)
+        return CE_INI_ERROR;
+
+    memcpy(sink->text + sink->length, data, length);
+    sink->length += length;
+    sink->flushes++;
+
+    return CE_INI_OK;
+}
+
+static int failSink(const char *data, size_t length, void *userdata)
+{
+    (void)data; (void)length; (void)userdata;
+    return CE_INI_ERROR;
+}
+
+static void testWriteSinks(void)
+{
+    static char buffer[1 << 20];
+    static char text[1 << 20];
+    Options     options = { 11 };
+    Sink        sink    = { text, 0, sizeof(text), 0 };
+    int         length;
+    FILE       *file;
+
+    /* More than one block. */
+    CHECK(CE_INI_WriteN(buffer, sizeof(buffer), &length, 10000, writeOption, &options) == CE_INI_OK);
+    CHECK(length > 2 * CE_INI_WRITE_BLOCK_SIZE);
+
+    CHECK(CE_INI_WriteSink(appendSink, &sink, 10000, writeOption, &options) == CE_INI_OK);
+    CHECK(sink.length == (size_t)length && memcmp(sink.text, buffer, length) == 0);
+    CHECK(sink.flushes >= 3);
+
+    CHECK(CE_INI_WriteSink(failSink, NULL, 10000, writeOption, &options) == CE_INI_ERROR);
+
+    if((file = tmpfile()) != NULL)
+    {
+        CHECK(CE_INI_WriteFILE(file, 10000, writeOption, &options) == CE_INI_OK);
+        rewind(file);
+        CHECK(fread(text, 1, sizeof(text), file) == (size_t)length && memcmp(text, buffer, length) == 0);
+        fclose(file);
+    }
+}
+
+static char* readTextFile(const char *path, size_t *length)
+{
+    FILE  *file = fopen(path, "rb");
+    char  *text = (char*)malloc(1 << 16);
+
+    *length = 0;
+
+    if(file)
+    {
+        *length = fread(text, 1, (1 << 16) - 1, file);
+        fclose(file);
+    }
+
+    text[*length] = '\0';
+    return text;
+}
+
+static void testWriteFile(void)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    const char *path = "ce_ini_test_write.ini";
+    static char buffer[1 << 16];
+    Options     options = { 3 };
+    size_t      length;
+    char       *text;
+
+    CHECK(writeTextFile(path, "old contents\n"));
+    CHECK(CE_INI_WriteFile(path, 200, writeOption, &options) == CE_INI_OK);
+    CHECK(CE_INI_WriteN(buffer, sizeof(buffer), NULL, 200, writeOption, &options) == CE_INI_OK);
+
+    text = readTextFile(path, &length);
+    CHECK(length == strlen(buffer) && strcmp(text, buffer) == 0);
+    free(text);
+
+    /* The temporary file cannot be created in a missing directory. */
+    CHECK(CE_INI_WriteFile("ce_ini_test_missing/write.ini", 200, writeOption, &options) == CE_INI_ERROR);
+
+    remove(path);
+#endif
+}
+
+static void testWriteFileKeepsMode(void)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    const char *path = "ce_ini_test_mode.ini";
+    Options     options = { 1 };
+    struct stat st;
+
+    CHECK(writeTextFile(path, "old contents\n"));
+    CHECK(chmod(path, 0664) == 0);
+    umask(022);
+
+    CHECK(CE_INI_WriteFile(path, 3, writeOption, &options) == CE_INI_OK);
+    CHECK(stat(path, &st) == 0 && (st.st_mode & 07777) == 0664);
+
+    remove(path);
+#endif
+}
+
+
+/*----------------------------------------------------------------------------
+ * Editor
+ *---------------------------------------------------------------------------*/
+static void testEditorKeepsLayout(void)
+{
+    const char    *text = "; settings\n[a]\nx = 1 ; one\ny=\"two\"\n\n[b]\nz = 3\n";
+    CE_INI_Editor  editor;
+    Output         output;
+    const char    *saved;
+
+    CHECK(CE_INI_EditorLoad(&editor, text, strlen(text)) == CE_INI_OK);
+    saved = saveEditor(&editor, &output);
+    CHECK(saved && strcmp(saved, text) == 0);
+
+    CHECK(CE_INI_EditorSet(&editor, "a", "x", "10") == CE_INI_OK);
+    CHECK(CE_INI_EditorSet(&editor, "a", "y", "2 2") == CE_INI_OK);
+    CHECK(CE_INI_EditorRemove(&editor, "b", "z") == CE_INI_OK);
+    CHECK(CE_INI_EditorSet(&editor, "a", "w", "4") == CE_INI_OK);
+    CHECK(CE_INI_EditorSet(&editor, "c", "v", "5") == CE_INI_OK);
+    saved = saveEditor(&editor, &output);
+    CHECK(saved && strcmp(saved, "; settings\n[a]\nx = 10 ; one\ny=\"2 2\"\nw=4\n\n[b]\n\n[c]\nv=5\n") == 0);
+
+    CHECK(CE_INI_EditorSet(&editor, "a", "bad name", "1") == CE_INI_ERROR);
+
+    CE_INI_EditorFree(&editor);
+}
+
+static void testEditorEmptyValueAtEnd(void)
+{
+    /* Not '\0' terminated, the empty value ends the buffer. */
+    char          *text = (char*)malloc(7);
+    CE_INI_Editor  editor;
+    Output         output;
+    const char    *saved;
+
+    memcpy(text, "[a]\nx =", 7);
+
+    CHECK(CE_INI_EditorLoad(&editor, text, 7) == CE_INI_OK);
+    CHECK(CE_INI_EditorSet(&editor, "a", "x", "1") == CE_INI_OK);
+    saved = saveEditor(&editor, &output);
+    CHECK(saved && strcmp(saved, "[a]\nx =1") == 0);
+
+    CE_INI_EditorFree(&editor);
+    free(text);
+}
+
+static void testEditorSetEmptyValueCRLF(void)
+{
+    const char    *text = "[a]\r\nx =\r\ny = 2\r\n";
+    CE_INI_Editor  editor;
+    Output         output;
+    const char    *saved;
+
+    CHECK(CE_INI_EditorLoad(&editor, text, strlen(text)) == CE_INI_OK);
+    CHECK(CE_INI_EditorSet(&editor, "a", "x", "v") == CE_INI_OK);
+    saved = saveEditor(&editor, &output);
+    CHECK(saved && strcmp(saved, "[a]\r\nx =v\r\ny = 2\r\n") == 0);
+
+    CE_INI_EditorFree(&editor);
+}
+
+static void testEditorRemoveOnlyPairOfNewSection(void)
+{
+    const char    *text = "[a]\nx=1\n";
+    CE_INI_Editor  editor;
+    Output         output;
+    const char    *saved;
+
+    CHECK(CE_INI_EditorLoad(&editor, text, strlen(text)) == CE_INI_OK);
+    CHECK(CE_INI_EditorSet(&editor, "new", "k", "v") == CE_INI_OK);
+    CHECK(CE_INI_EditorRemove(&editor, "new", "k") == CE_INI_OK);
+    saved = saveEditor(&editor, &output);
+    CHECK(saved && strcmp(saved, text) == 0);
+
+    CHECK(CE_INI_EditorSet(&editor, "new", "k", "w") == CE_INI_OK);
+    saved = saveEditor(&editor, &output);
+    CHECK(saved && strcmp(saved, "[a]\nx=1\n\n[new]\nk=w\n") == 0);
+
+    CE_INI_EditorFree(&editor);
+}
+
+static void testEditorDuplicatePairs(void)
+{
+    const char    *text = "[a]\nx=1\nx=2\n";
+    CE_INI_Editor  editor;
+    Output         output;
+    const char    *saved;
+
+    CHECK(CE_INI_EditorLoad(&editor, text, strlen(text)) == CE_INI_OK);
+    CHECK(CE_INI_EditorSet(&editor, "a", "x", "3") == CE_INI_OK);
+    saved = saveEditor(&editor, &output);
+    CHECK(saved && strcmp(saved, "[a]\nx=1\nx=3\n") == 0);
+
+    CHECK(CE_INI_EditorRemove(&editor, "a", "x") == CE_INI_OK);
+    saved = saveEditor(&editor, &output);
+    CHECK(saved && strcmp(saved, "[a]\n") == 0);
+
+    CE_INI_EditorFree(&editor);
+}
+
+static void testEditorManyPairs(void)
+{
+    CE_INI_Editor  editor;
+    Output         output;
+    char           section[16];
+    char           name[16];
+
+    /* Enough sections and pairs to grow both tables a few times. */
+    CHECK(CE_INI_EditorLoad(&editor, "", 0) == CE_INI_OK);
+
+    for(int i = 0; i < 500; i++)
+    {
+        sprintf(section, "s%d", i % 40);
+        sprintf(name, "k%d", i);
+        CHECK(CE_INI_EditorSet(&editor, section, name, "v") == CE_INI_OK);
+    }
+
+    for(int i = 0; i < 500; i++)
+    {
+        sprintf(section, "s%d", i % 40);
+        sprintf(name, "k%d", i);
+        CHECK(CE_INI_EditorRemove(&editor, section, name) == CE_INI_OK);
+    }
+
+    CHECK(editor.section_count == 41);
+    CHECK(saveEditor(&editor, &output) && output.length == 0);
+
+    CE_INI_EditorFree(&editor);
+}
+
+static void testEditorRemoveMissing(void)
+{
+    const char    *text = "[a]\nx=1\n";
+    CE_INI_Editor  editor;
+
+    CHECK(CE_INI_EditorLoad(&editor, text, strlen(text)) == CE_INI_OK);
+    CHECK(CE_INI_EditorRemove(&editor, "a", "y") == CE_INI_ERROR);
+    CHECK(CE_INI_EditorRemove(&editor, "a", "x") == CE_INI_OK);
+    CHECK(CE_INI_EditorRemove(&editor, "a", "x") == CE_INI_ERROR);
+
+    CE_INI_EditorFree(&editor);
+}
+
+static void testEditorRemoveMissingReported(void)
+{
+    const char    *text = "[a]\nx=1\n";
+    CE_INI_Editor  editor;
+
+    CHECK(CE_INI_EditorLoad(&editor, text, strlen(text)) == CE_INI_OK);
+
+    errorCount = 0;
+    CE_INI_SetErrorCallback(countError, NULL);
+    CHECK(CE_INI_EditorRemove(&editor, "a", "y") == CE_INI_ERROR);
+    CHECK(errorCount == 1 && errorCode == CE_INI_ERROR_ARGUMENT);
+    CE_INI_SetErrorCallback(NULL, NULL);
+
+    CE_INI_EditorFree(&editor);
+}
+
+
+/*----------------------------------------------------------------------------
+ * Statistics
+ *---------------------------------------------------------------------------*/
+#ifdef CE_INI_STATS
+static void testStatsCounters(void)
+{
+    const char  *text = "; one\n[a]\nx = 1\ny = \"t\\tt\\n\"\n; two\n[b]\nz = 3";
+    CE_INI_Stats stats;
+    Output       output;
+    char         buffer[256];
+    Options      options = { 2 };
+    int          length;
+
+    memset(&stats, 0, sizeof(stats));
+    CE_INI_SetStats(&stats);
+
+    clearOutput(&output);
+    CHECK(CE_INI_ReadSlices(text, strlen(text), collectSlice, &output) == CE_INI_OK);
+    CHECK(stats.bytes_scanned == strlen(text));
+    CHECK(stats.lines == 7);
+    CHECK(stats.sections == 2);
+    CHECK(stats.keys == 3);
+    CHECK(stats.comments == 2);
+    CHECK(stats.escapes == 2);
+
+    CHECK(CE_INI_WriteN(buffer, sizeof(buffer), &length, 4, writeOption, &options) == CE_INI_OK);
+    CHECK(stats.bytes_written == (size_t)length);
+
+    /* Nothing is counted once stopped. */
+    CE_INI_SetStats(NULL);
+    CHECK(CE_INI_ReadSlices(text, strlen(text), collectSlice, &output) == CE_INI_OK);
+    CHECK(stats.keys == 3);
+}
+#endif
+
+
+/*----------------------------------------------------------------------------
+ * Errors
+ *---------------------------------------------------------------------------*/
+static void testReadExPosition(void)
+{
+    const char  *text = "[a]\nx = 1\ny ! 2\n";
+    CE_INI_Error error;
+    Output       output;
+
+    clearOutput(&output);
+    CHECK(CE_INI_ReadEx(text, strlen(text), collectPair, &output, &error) == CE_INI_ERROR);
+    CHECK(error.code == CE_INI_ERROR_SYNTAX);
+    CHECK(error.offset == 12 && error.line == 3 && error.column == 3);
+    CHECK(strcmp(output.text, "a.x=1|") == 0);
+
+    CHECK(CE_INI_ReadEx("[a]\nx = \"\\q\"\n", 13, collectPair, &output, &error) == CE_INI_ERROR);
+    CHECK(error.code == CE_INI_ERROR_ESCAPE && error.line == 2 && error.column == 6);
+
+    CHECK(CE_INI_ReadEx("[a]\r\n\tk\x01 = 1\r\n", 14, collectPair, &output, &error) == CE_INI_ERROR);
+    CHECK(error.code == CE_INI_ERROR_CHARACTER && error.offset == 7 && error.line == 2 && error.column == 3);
+
+    CHECK(CE_INI_ReadEx(text, 10, collectPair, &output, &error) == CE_INI_OK);
+    CHECK(error.code == CE_INI_ERROR_NONE);
+}
+
+static void testErrorCallbackOnce(void)
+{
+    Output output;
+
+    errorCount = 0;
+    CE_INI_SetErrorCallback(countError, NULL);
+
+    CHECK(CE_INI_ReadN("[a\n", 3, collectPair, &output) == CE_INI_ERROR);
+    CHECK(errorCount == 1 && errorCode == CE_INI_ERROR_CHARACTER);
+
+    CHECK(CE_INI_ReadN("[a]\n", 4, collectPair, &output) == CE_INI_OK);
+    CHECK(errorCount == 1);
+
+    CE_INI_SetErrorCallback(NULL, NULL);
+    CHECK(CE_INI_ReadN("[a\n", 3, collectPair, &output) == CE_INI_ERROR);
+    CHECK(errorCount == 1);
+}
+
+#ifdef CE_INI_PTHREADS
+static void countOnThread(const CE_INI_Error *error, void *userdata)
+{
+    (void)error;
+    (*(int*)userdata)++;
+}
+
+static void* failOnThread(void *userdata)
+{
+    Output output;
+
+    clearOutput(&output);
+
+    /* The callback of the main thread does not apply here. */
+    CE_INI_ReadN("[a\n", 3, collectPair, &output);
+
+    CE_INI_SetErrorCallback(countOnThread, userdata);
+    CE_INI_ReadN("[a\n", 3, collectPair, &output);
+
+    return NULL;
+}
+
+static void testErrorCallbackPerThread(void)
+{
+    pthread_t thread;
+    int       seen = 0;
+    Output    output;
+
+    errorCount = 0;
+    CE_INI_SetErrorCallback(countError, NULL);
+
+    CHECK(pthread_create(&thread, NULL, failOnThread, &seen) == 0);
+    pthread_join(thread, NULL);
+    CHECK(errorCount == 0 && seen == 1);
+
+    clearOutput(&output);
+    CHECK(CE_INI_ReadN("[a\n", 3, collectPair, &output) == CE_INI_ERROR);
+    CHECK(errorCount == 1 && seen == 1);
+
+    CE_INI_SetErrorCallback(NULL, NULL);
+}
+#endif
+
+static void testReadLenient(void)
+{
+    const char        *text = "[a]\nx = 1\nbad line\ny = 2\n[b\nz = \"\\q\"\nw = 4\n";
+    CE_INI_Diagnostics diagnostics;
+    Output             output;
+
+    memset(&diagnostics, 0, sizeof(diagnostics));
+    clearOutput(&output);
+
+    CHECK(CE_INI_ReadLenient(text, strlen(text), collectSlice, &output, &diagnostics) == CE_INI_ERROR);
+    CHECK(strcmp(output.text, "a.x=1|a.y=2|a.w=4|") == 0);
+    CHECK(diagnostics.count == 3);
+
+    if(diagnostics.count == 3)
+    {
+        CHECK(diagnostics.errors[0].code == CE_INI_ERROR_SYNTAX && diagnostics.errors[0].line == 3);
+        CHECK(diagnostics.errors[1].code == CE_INI_ERROR_CHARACTER && diagnostics.errors[1].line == 5);
+        CHECK(diagnostics.errors[2].code == CE_INI_ERROR_ESCAPE && diagnostics.errors[2].line == 6);
+    }
+
+    CE_INI_DiagnosticsFree(&diagnostics);
+
+    memset(&diagnostics, 0, sizeof(diagnostics));
+    CHECK(CE_INI_ReadLenient("[a]\nx = 1\n", 10, collectSlice, &output, &diagnostics) == CE_INI_OK);
+    CHECK(diagnostics.count == 0);
+    CE_INI_DiagnosticsFree(&diagnostics);
+}
+
+
+/*----------------------------------------------------------------------------
+ * Cursor and Builder
+ *---------------------------------------------------------------------------*/
+static void testCursor(void)
+{
+    const char   *text = "[a]\nx = 1\ny = \"t\\tt\"\n[b]\nz =";
+    CE_INI_Cursor cursor;
+    Output        output;
+    int           result;
+
+    clearOutput(&output);
+    CE_INI_CursorInit(&cursor, text, strlen(text));
+
+    while((result = CE_INI_Next(&cursor)) > 0)
+        collectSlice(cursor.section, cursor.section_length, cursor.name, cursor.name_length, cursor.value, cursor.value_length, &output);
+
+    CHECK(result == 0);
+    CHECK(strcmp(output.text, "a.x=1|a.y=t\tt|b.z=|") == 0);
+
+    CE_INI_CursorInit(&cursor, "[a]\nx = 1\ny\n", 12);
+    CHECK(CE_INI_Next(&cursor) == 1);
+    CHECK(CE_INI_Next(&cursor) == -1);
+}
+
+static void testBuilderMatchesSink(void)
+{
+    static char    expected[1 << 16];
+    static char    text[1 << 16];
+    Options        options = { 4 };
+    Sink           sink    = { text, 0, sizeof(text), 0 };
+    CE_INI_Builder builder;
+    char           section[CE_INI_MAX_SECTION_LENGTH];
+    char           name[CE_INI_MAX_NAME_LENGTH];
+    char           value[CE_INI_MAX_VALUE_LENGTH];
+    int            length;
+
+    CHECK(CE_INI_WriteN(expected, sizeof(expected), &length, 300, writeOption, &options) == CE_INI_OK);
+
+    CE_INI_BuilderInit(&builder, 0);
+
+    for(int i = 0; i < 300; i++)
+    {
+        writeOption(i, section, name, value, &options);
+        CHECK(CE_INI_BuilderAdd(&builder, section, name, value) == CE_INI_OK);
+    }
+
+    CHECK(CE_INI_BuilderSink(&builder, appendSink, &sink) == CE_INI_OK);
+    CHECK(sink.length == (size_t)length && memcmp(text, expected, length) == 0);
+
+    CE_INI_BuilderFree(&builder);
+}
+
+#ifdef __cplusplus
+static void testTemplates(void)
+{
+    const char *text = "[a]\nx = 1\ny = 2\n";
+    std::size_t pairs = 0;
+    int         sum   = 0;
+    Output      output;
+
+    CHECK(ce::ini::read(text, [&](const char *, int, const char *, int, const char *value, int) { pairs++; sum += atoi(value); }) == CE_INI_OK);
+    CHECK(pairs == 2 && sum == 3);
+
+    clearOutput(&output);
+    CHECK(ce::ini::write([&](const char *data, size_t length) { return appendText(&output, data, length); }, 2,
+                         [](int index, char *section, char *name, char *value) {
+                             strcpy(section, "s");
+                             sprintf(name, "k%d", index);
+                             sprintf(value, "%d", index);
+                         }) == CE_INI_OK);
+    CHECK(strstr(output.text, "[s]") && strstr(output.text, "k1=1"));
+}
+#endif
+
+#if defined(__cplusplus) && (__cplusplus >= 202002L)
+static constexpr auto defaults = ce::ini::parse<"[server]\nport = 80\nname = \"a\\tb\"\n[server]\nport = 8080\n">();
+
+static_assert(defaults.size() == 3, "every pair is kept");
+static_assert(defaults.get("server", "port")[0] == '8', "later duplicates win");
+static_assert(defaults.get("server", "name")[1] == '\t', "escapes are decoded");
+static_assert(defaults.get("server", "host") == nullptr, "unknown pairs are NULL");
+
+static void testConstexprTable(void)
+{
+    Output output;
+
+    clearOutput(&output);
+    defaults.read([&](const char *section, int section_length, const char *name, int name_length, const char *value, int value_length) {
+        collectSlice(section, section_length, name, name_length, value, value_length, &output);
+    });
+    CHECK(strcmp(output.text, "server.port=80|server.name=a\tb|server.port=8080|") == 0);
+    CHECK(strcmp(defaults[1].name, "name") == 0);
+}
+#endif
+
+
+/*----------------------------------------------------------------------------
+ * Schema
+ *---------------------------------------------------------------------------*/
+typedef struct
+{
+    char      host[16];
+    int       port;
+    long long limit;
+    double    ratio;
+    int       verbose;
+} Config;
+
+static const CE_INI_Binding config_bindings[] =
+{
+    CE_INI_BIND("server", "host",    CE_INI_TYPE_STRING, Config, host),
+    CE_INI_BIND("server", "port",    CE_INI_TYPE_INT,    Config, port),
+    CE_INI_BIND("server", "limit",   CE_INI_TYPE_LONG,   Config, limit),
+    CE_INI_BIND("",       "ratio",   CE_INI_TYPE_DOUBLE, Config, ratio),
+    CE_INI_BIND("log",    "verbose", CE_INI_TYPE_BOOL,   Config, verbose)
+};
+
+static void testSchemaBinding(void)
+{
+    const char   *text = "ratio = 0.5\n[server]\nhost = \"example\"\nport = 8080\nlimit = -9000000000\n[log]\nverbose = yes\n";
+    CE_INI_Schema schema;
+    Config        config;
+
+    memset(&config, 0, sizeof(config));
+    CHECK(CE_INI_SchemaInit(&schema, config_bindings, 5, 0) == CE_INI_OK);
+    CHECK(CE_INI_ReadBound(text, strlen(text), &schema, &config) == CE_INI_OK);
+    CHECK(strcmp(config.host, "example") == 0);
+    CHECK(config.port == 8080);
+    CHECK(config.limit == -9000000000LL);
+    CHECK(config.ratio == 0.5);
+    CHECK(config.verbose == 1);
+
+    /* Unknown pairs fail unless ignored, bad values leave the field. */
+    CHECK(CE_INI_ReadBound("[server]\nother = 1\n", 19, &schema, &config) == CE_INI_ERROR);
+    CHECK(CE_INI_ReadBound("[server]\nport = x\n", 18, &schema, &config) == CE_INI_ERROR);
+    CHECK(config.port == 8080);
+    CHECK(CE_INI_ReadBound("[server]\nhost = \"a very long host name\"\n", 40, &schema, &config) == CE_INI_ERROR);
+    CE_INI_SchemaFree(&schema);
+
+    CHECK(CE_INI_SchemaInit(&schema, config_bindings, 5, CE_INI_SCHEMA_IGNORE_UNKNOWN) == CE_INI_OK);
+    CHECK(CE_INI_ReadBound("[server]\nother = 1\nport = 1\n", 28, &schema, &config) == CE_INI_OK);
+    CHECK(config.port == 1);
+    CE_INI_SchemaFree(&schema);
+}
+
+
+/*----------------------------------------------------------------------------
+ * Conversions
+ *---------------------------------------------------------------------------*/
+static int convertError(int result)
+{
+    return result == CE_INI_OK ? CE_INI_ERROR_NONE : errorCode;
+}
+
+static void testConvertIntegers(void)
+{
+    int       i = 0;
+    long long l = 0;
+
+    CE_INI_SetErrorCallback(countError, NULL);
+    CHECK(CE_INI_ToInt("-2147483648", 11, &i) == CE_INI_OK && i == -2147483647 - 1);
+    CHECK(CE_INI_ToInt("+0042", 5, &i) == CE_INI_OK && i == 42);
+    CHECK(convertError(CE_INI_ToInt("2147483648", 10, &i)) == CE_INI_ERROR_RANGE && i == 42);
+    CHECK(convertError(CE_INI_ToInt("12a", 3, &i)) == CE_INI_ERROR_VALUE);
+    CHECK(convertError(CE_INI_ToInt("", 0, &i)) == CE_INI_ERROR_VALUE);
+    CHECK(CE_INI_ToLong("-9223372036854775808", 20, &l) == CE_INI_OK && l == -9223372036854775807LL - 1);
+    CHECK(convertError(CE_INI_ToLong("9223372036854775808", 19, &l)) == CE_INI_ERROR_RANGE);
+    CE_INI_SetErrorCallback(NULL, NULL);
+}
+
+static void testConvertDoubles(void)
+{
+    double d = 0;
+
+    CE_INI_SetErrorCallback(countError, NULL);
+    CHECK(CE_INI_ToDouble("0.1", 3, &d) == CE_INI_OK && d == 0.1);
+    CHECK(CE_INI_ToDouble("-2.5e3", 6, &d) == CE_INI_OK && d == -2500.0);
+    CHECK(CE_INI_ToDouble("123456789012345678901234567890", 30, &d) == CE_INI_OK && d == 123456789012345678901234567890.0);
+    CHECK(CE_INI_ToDouble("1.7976931348623157e308", 22, &d) == CE_INI_OK && d == 1.7976931348623157e308);
+    CHECK(convertError(CE_INI_ToDouble("1e309", 5, &d)) == CE_INI_ERROR_RANGE);
+    CHECK(convertError(CE_INI_ToDouble("1.", 2, &d)) == CE_INI_OK);
+    CHECK(convertError(CE_INI_ToDouble(".", 1, &d)) == CE_INI_ERROR_VALUE);
+    CHECK(convertError(CE_INI_ToDouble("inf", 3, &d)) == CE_INI_ERROR_VALUE);
+    CHECK(convertError(CE_INI_ToDouble("1e", 2, &d)) == CE_INI_ERROR_VALUE);
+    CE_INI_SetErrorCallback(NULL, NULL);
+}
+
+static void testConvertUnits(void)
+{
+    unsigned long long size = 0;
+    long long          duration = 0;
+    int                b = -1;
+
+    CE_INI_SetErrorCallback(countError, NULL);
+    CHECK(CE_INI_ToBool("on", 2, &b) == CE_INI_OK && b == 1);
+    CHECK(CE_INI_ToBool("False", 5, &b) == CE_INI_OK && b == 0);
+    CHECK(convertError(CE_INI_ToBool("yes!", 4, &b)) == CE_INI_ERROR_VALUE);
+    CHECK(CE_INI_ToSize("64MiB", 5, &size) == CE_INI_OK && size == 64ull << 20);
+    CHECK(CE_INI_ToSize("64 mb", 5, &size) == CE_INI_OK && size == 64000000ull);
+    CHECK(CE_INI_ToSize("12", 2, &size) == CE_INI_OK && size == 12);
+    CHECK(convertError(CE_INI_ToSize("16777216 TiB", 12, &size)) == CE_INI_ERROR_RANGE);
+    CHECK(convertError(CE_INI_ToSize("1 parsec", 8, &size)) == CE_INI_ERROR_VALUE);
+    CHECK(CE_INI_ToDuration("1h30m", 5, &duration) == CE_INI_OK && duration == 5400000000000LL);
+    CHECK(CE_INI_ToDuration("250ms", 5, &duration) == CE_INI_OK && duration == 250000000LL);
+    CHECK(convertError(CE_INI_ToDuration("5", 1, &duration)) == CE_INI_ERROR_VALUE);
+    CE_INI_SetErrorCallback(NULL, NULL);
+}
+
+static void testConvertSizeTwentyDigits(void)
+{
+    unsigned long long n = 0;
+
+    CE_INI_SetErrorCallback(countError, NULL);
+    CHECK(CE_INI_ToSize("18446744073709551615", 20, &n) == CE_INI_OK && n == 18446744073709551615ull);
+    CHECK(CE_INI_ToSize("0018446744073709551615", 22, &n) == CE_INI_OK && n == 18446744073709551615ull);
+    CHECK(CE_INI_ToSize("10000000000000000000", 20, &n) == CE_INI_OK && n == 10000000000000000000ull);
+    CHECK(convertError(CE_INI_ToSize("18446744073709551616", 20, &n)) == CE_INI_ERROR_RANGE);
+    CHECK(convertError(CE_INI_ToSize("99999999999999999999", 20, &n)) == CE_INI_ERROR_RANGE);
+    CHECK(convertError(CE_INI_ToSize("100000000000000000000", 21, &n)) == CE_INI_ERROR_RANGE);
+    CE_INI_SetErrorCallback(NULL, NULL);
+}
+
+static void testConvertDoubleUnderflow(void)
+{
+    double n = 1;
+
+    CE_INI_SetErrorCallback(countError, NULL);
+    CHECK(convertError(CE_INI_ToDouble("1e-400", 6, &n)) == CE_INI_ERROR_RANGE && n == 1);
+    CHECK(convertError(CE_INI_ToDouble("-0.0001e-330", 12, &n)) == CE_INI_ERROR_RANGE && n == 1);
+    CHECK(CE_INI_ToDouble("0e-400", 6, &n) == CE_INI_OK && n == 0);
+    CHECK(CE_INI_ToDouble("4.9e-324", 8, &n) == CE_INI_OK && n > 0);
+    CE_INI_SetErrorCallback(NULL, NULL);
+}
+
+static void testConvertBoolLettersOnly(void)
+{
+    int n = -1;
+
+    CE_INI_SetErrorCallback(countError, NULL);
+    CHECK(CE_INI_ToBool("TRUE", 4, &n) == CE_INI_OK && n == 1);
+    CHECK(CE_INI_ToBool("No", 2, &n) == CE_INI_OK && n == 0);
+    CHECK(convertError(CE_INI_ToBool("\x11", 1, &n)) == CE_INI_ERROR_VALUE);
+    CHECK(convertError(CE_INI_ToBool("\x10", 1, &n)) == CE_INI_ERROR_VALUE);
+    CHECK(convertError(CE_INI_ToBool("n@", 2, &n)) == CE_INI_ERROR_VALUE);
+    CE_INI_SetErrorCallback(NULL, NULL);
+}
+
+static void testConvertDoubleLongMantissa(void)
+{
+    /* 2^53 + 1 lies halfway between two doubles. A 1 hundreds of digits
+       later rounds it up, without it the tie goes to the even one. */
+    static const char halfway_up[] =
+        "9007199254740993.00000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000001";
+    static const char halfway[] =
+        "9007199254740993.0000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000";
+    double d = 0;
+
+    CHECK(CE_INI_ToDouble(halfway_up, (int)strlen(halfway_up), &d) == CE_INI_OK && d == 9007199254740994.0);
+    CHECK(CE_INI_ToDouble(halfway, (int)strlen(halfway), &d) == CE_INI_OK && d == 9007199254740992.0);
+    CHECK(CE_INI_ToDouble("2.2250738585072011e-308", 23, &d) == CE_INI_OK && d == 2.2250738585072011e-308);
+
+    /* The decimal point is always '.', whatever the locale says. */
+    if(setlocale(LC_NUMERIC, "de_DE.UTF-8") || setlocale(LC_NUMERIC, "fr_FR.UTF-8"))
+    {
+        CHECK(CE_INI_ToDouble("1.25", 4, &d) == CE_INI_OK && d == 1.25);
+        CHECK(CE_INI_ToDouble("1.000000000000000000000000000000000000000000000000000001", 56, &d) == CE_INI_OK && d == 1.0);
+        CHECK(CE_INI_ToDouble("1,25", 4, &d) == CE_INI_ERROR);
+        setlocale(LC_NUMERIC, "C");
+    }
+}
+
+
+/*----------------------------------------------------------------------------
+ * Stores
+ *---------------------------------------------------------------------------*/
+#ifdef CE_INI_STORE
+static void testStoreReload(void)
+{
+    const char       *path = "ce_ini_test_store.ini";
+    CE_INI_Store      store;
+    const CE_INI_Doc *doc;
+    const char       *value;
+    int               reader;
+
+    CHECK(writeTextFile(path, "[s]\na = 1\n"));
+    CHECK(CE_INI_StoreOpen(&store, path, 4) == CE_INI_OK);
+    CHECK((reader = CE_INI_StoreRegister(&store)) >= 0);
+
+    doc = CE_INI_StoreAcquire(&store, reader);
+    CHECK((value = CE_INI_Get(doc, "s", "a")) && strcmp(value, "1") == 0);
+    CE_INI_StoreRelease(&store, reader);
+
+    CHECK(writeTextFile(path, "[s]\na = 2\n"));
+    CHECK(CE_INI_StoreReload(&store) == CE_INI_OK);
+
+    doc = CE_INI_StoreAcquire(&store, reader);
+    CHECK((value = CE_INI_Get(doc, "s", "a")) && strcmp(value, "2") == 0);
+    CE_INI_StoreRelease(&store, reader);
+
+    /* A broken file keeps the current document. */
+    CHECK(writeTextFile(path, "[s\n"));
+    CHECK(CE_INI_StoreReload(&store) == CE_INI_ERROR);
+
+    doc = CE_INI_StoreAcquire(&store, reader);
+    CHECK((value = CE_INI_Get(doc, "s", "a")) && strcmp(value, "2") == 0);
+    CE_INI_StoreRelease(&store, reader);
+
+    CE_INI_StoreUnregister(&store, reader);
+    CE_INI_StoreClose(&store);
+    remove(path);
+}
+#endif
+
+#ifdef CE_INI_STORE
+static void testStoreReadersAligned(void)
+{
+    const char *path = "ce_ini_test_store.ini";
+
+    CHECK(writeTextFile(path, "[s]\na = 1\n"));
+
+    for(int reader_count = 1; reader_count <= 8; reader_count++)
+    {
+        CE_INI_Store store;
+
+        CHECK(CE_INI_StoreOpen(&store, path, reader_count) == CE_INI_OK);
+        CHECK((size_t)store.readers % CE_INI_CACHE_LINE == 0);
+        CE_INI_StoreClose(&store);
+    }
+
+    remove(path);
+}
+#endif
+
+
+int main(void)
+{
+    testReadNUnterminated();
+    testReadNLimits();
+    testReadSlices();
+    testReadSectionTooLong();
+    testScannerLengths();
+    testCharacterClasses();
+    testFeedChunks();
+    testFeedError();
+    testReadFile();
+    testReadParallelOrder();
+    testDocLookup();
+    testDocManyPairs();
+    testReadArena();
+    testArenaAlloc();
+    testArenaAllocAfterRead();
+    testWriteGroups();
+    testWriteManyOptions();
+    testWriteNLength();
+    testWriteSizeQuery();
+    testWriteSinks();
+    testWriteFile();
+    testWriteFileKeepsMode();
+    testEditorKeepsLayout();
+    testEditorEmptyValueAtEnd();
+    testEditorSetEmptyValueCRLF();
+    testEditorRemoveOnlyPairOfNewSection();
+    testEditorDuplicatePairs();
+    testEditorManyPairs();
+    testEditorRemoveMissing();
+#ifdef CE_INI_STATS
+    testStatsCounters();
+#endif
+    testEditorRemoveMissingReported();
+    testReadExPosition();
+    testErrorCallbackOnce();
+#ifdef CE_INI_PTHREADS
+    testErrorCallbackPerThread();
+#endif
+    testReadLenient();
+    testCursor();
+    testBuilderMatchesSink();
+#ifdef __cplusplus
+    testTemplates();
+#endif
+#if defined(__cplusplus) && (__cplusplus >= 202002L)
+    testConstexprTable();
+#endif
+    testSchemaBinding();
+    testConvertIntegers();
+    testConvertDoubles();
+    testConvertUnits();
+    testConvertSizeTwentyDigits();
+    testConvertDoubleUnderflow();
+    testConvertBoolLettersOnly();
+    testConvertDoubleLongMantissa();
+#ifdef CE_INI_STORE
+    testStoreReload();
+#endif
+#ifdef CE_INI_STORE
+    testStoreReadersAligned();
+#endif
+
+    if(failures)
+    {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+
+    printf("all checks passed\n");
+    return 0;
+}